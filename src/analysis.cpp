@@ -0,0 +1,99 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "analysis.h"
+
+#include <sstream>
+
+#include "fen.h"
+#include "helpers.h"
+
+namespace Analysis {
+
+namespace {
+
+std::string move_str(Move m) {
+  return m == Move() ? "0000" : PrintingHelpers::move_to_str(m);
+}
+
+std::string quoted(const std::string& s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') out += '\\';
+    if (static_cast<unsigned char>(c) >= 0x20) out += c;
+  }
+  return out + "\"";
+}
+
+}  // namespace
+
+Result analyse(size_t index, const std::string& fen, FoChess::SearchInstance& search,
+               TranspositionTable& tt, const Limits& limits) {
+  Result result;
+  result.index = index;
+  result.fen = fen;
+
+  Board board;
+  result.error = FEN::parse(fen, board);
+  if (result.error != FEN::Error::NONE) return result;
+
+  FoChess::ScopedSearch bind(search);
+  tt.clear();
+  search.state.node_limit = limits.nodes;
+  FoChess::iterative_deepening(limits.depth, board, tt, limits.movetime_ms);
+  search.state.node_limit = 0;
+
+  result.move = search.stats.best_move.load(std::memory_order_relaxed);
+  result.score = search.stats.best_root_score.load(std::memory_order_relaxed);
+  result.depth = search.stats.highest_depth.load(std::memory_order_relaxed);
+  result.nodes = search.stats.nodes();
+  result.time_ms = search.stats.elapsed_ms(search.state);
+  const FoChess::PVLine& pv = search.stats.pv;
+  result.pv.assign(pv.moves.begin(), pv.moves.begin() + static_cast<std::ptrdiff_t>(pv.length));
+  return result;
+}
+
+std::string to_json(const Result& result) {
+  std::ostringstream ss;
+  ss << "{\"index\":" << result.index << ",\"fen\":" << quoted(result.fen);
+  if (result.error != FEN::Error::NONE) {
+    ss << ",\"error\":" << quoted(FEN::error_str(result.error)) << "}";
+    return ss.str();
+  }
+  ss << ",\"bestmove\":\"" << move_str(result.move) << "\",\"score\":{";
+  if (FoChess::is_mate_score(result.score))
+    ss << "\"mate\":" << FoChess::mate_in(result.score);
+  else
+    ss << "\"cp\":" << result.score;
+  ss << "},\"depth\":" << result.depth << ",\"nodes\":" << result.nodes
+     << ",\"time_ms\":" << result.time_ms << ",\"pv\":[";
+  for (size_t i = 0; i < result.pv.size(); ++i)
+    ss << (i ? "," : "") << '"' << move_str(result.pv[i]) << '"';
+  ss << "]}";
+  return ss.str();
+}
+
+void InOrder::push(size_t index, std::string line) {
+  std::lock_guard<std::mutex> lock(mtx);
+  if (index != next) {
+    held.emplace(index, std::move(line));
+    return;
+  }
+  emit(line);
+  ++next;
+  for (auto it = held.begin(); it != held.end() && it->first == next; it = held.erase(it)) {
+    emit(it->second);
+    ++next;
+  }
+}
+
+size_t InOrder::pending() {
+  std::lock_guard<std::mutex> lock(mtx);
+  return held.size();
+}
+
+}  // namespace Analysis
@@ -0,0 +1,78 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fen.h"
+#include "move.h"
+#include "search.h"
+#include "tt.h"
+
+/**
+ * Batch analysis of independent positions. Every worker searches with its
+ * own instance and TT, one position at a time, and results come out as
+ * one JSON object per line.
+ */
+namespace Analysis {
+
+struct Limits {
+  int depth = 64;
+  int64_t movetime_ms = 0;  // 0 for no time limit
+  uint64_t nodes = 0;       // 0 for no node limit
+};
+
+struct Result {
+  size_t index = 0;  // position in the input
+  std::string fen;
+  FEN::Error error = FEN::Error::NONE;  // the fen did not parse, nothing was searched
+  Move move;
+  int score = 0;
+  int depth = 0;
+  uint64_t nodes = 0;
+  int64_t time_ms = 0;
+  std::vector<Move> pv;
+};
+
+// Searches fen with the given instance bound to the calling thread. The
+// TT is cleared first, so results do not depend on what ran before. A fen
+// that does not parse is not searched, the result only carries the error.
+Result analyse(size_t index, const std::string& fen, FoChess::SearchInstance& search,
+               TranspositionTable& tt, const Limits& limits);
+
+// {"index":..,"fen":..,"bestmove":..,"score":{"cp":..}|{"mate":..},
+//  "depth":..,"nodes":..,"time_ms":..,"pv":[..]}
+// or {"index":..,"fen":..,"error":..} for a fen that did not parse
+std::string to_json(const Result& result);
+
+/**
+ * Passes lines on in index order whatever order they arrive in, holding
+ * back the ones whose predecessors are still being worked on.
+ */
+class InOrder {
+ public:
+  explicit InOrder(std::function<void(const std::string&)> fn) : emit(std::move(fn)) {}
+
+  void push(size_t index, std::string line);
+  size_t pending();
+
+ private:
+  std::function<void(const std::string&)> emit;
+  std::mutex mtx;
+  std::map<size_t, std::string> held;
+  size_t next = 0;
+};
+
+}  // namespace Analysis
@@ -0,0 +1,155 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "bitbase.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bitboard.h"
+
+namespace Bitbases {
+
+namespace {
+
+// Pawn on ranks 2-7 and files a-d
+constexpr size_t PAWN_SQUARES = 24;
+constexpr size_t KPK_SIZE = 2 * PAWN_SQUARES * 64 * 64;
+
+enum Result : uint8_t { UNKNOWN, INVALID, DRAW, WIN };
+
+// Bits 0-5 white king, 6-11 black king, 12 side to move, 13+ pawn
+constexpr size_t index(Color stm, Square bksq, Square wksq, Square psq) {
+  const size_t pawn = static_cast<size_t>(psq / 8 - 1) * 4 + psq % 8;
+  return wksq | (static_cast<size_t>(bksq) << 6) | (static_cast<size_t>(stm) << 12) |
+         (pawn << 13);
+}
+
+struct Position {
+  Color stm;
+  Square wksq, bksq, psq;
+};
+
+constexpr Position decode(size_t idx) {
+  const size_t pawn = idx >> 13;
+  return {Color((idx >> 12) & 1), Square(idx & 63), Square((idx >> 6) & 63),
+          Square((pawn / 4 + 1) * 8 + pawn % 4)};
+}
+
+// Everything that does not depend on the rest of the table
+Result classify_leaf(const Position& p) {
+  const Bitboard wk = Bitboards::square_bb(p.wksq);
+  const Bitboard bk = Bitboards::square_bb(p.bksq);
+  const Bitboard pawn = Bitboards::square_bb(p.psq);
+
+  if ((wk | bk) & pawn || p.wksq == p.bksq || Bitboards::king_attacks(p.wksq) & bk ||
+      (p.stm == WHITE && Bitboards::pawn_attacks_mask(p.psq, WHITE) & bk))
+    return INVALID;
+
+  if (p.stm == WHITE) {
+    // Promotes and the new queen cannot be taken
+    const Square queen = Bitboards::up(p.psq);
+    if (p.psq / 8 == 1 && queen != p.wksq && queen != p.bksq &&
+        (!(Bitboards::king_attacks(p.bksq) & Bitboards::square_bb(queen)) ||
+         Bitboards::king_attacks(p.wksq) & Bitboards::square_bb(queen)))
+      return WIN;
+    return UNKNOWN;
+  }
+
+  const Bitboard covered = Bitboards::king_attacks(p.wksq) |
+                           Bitboards::pawn_attacks_mask(p.psq, WHITE);
+  const Bitboard escapes = Bitboards::king_attacks(p.bksq) & ~covered;
+
+  // Stalemate, or the pawn hangs
+  if (!escapes || escapes & pawn) return DRAW;
+  return UNKNOWN;
+}
+
+// White needs one winning move, black one drawing move
+Result classify(const std::vector<Result>& db, const Position& p) {
+  const Color them = Color(BLACK - p.stm);
+  const Result good = p.stm == WHITE ? WIN : DRAW;
+  const Result bad = p.stm == WHITE ? DRAW : WIN;
+  bool unknown = false;
+
+  auto visit = [&](Square wksq, Square bksq, Square psq) {
+    const Result r = db[index(them, bksq, wksq, psq)];
+    if (r == UNKNOWN) unknown = true;
+    return r == good;
+  };
+
+  if (p.stm == WHITE) {
+    Bitboard king = Bitboards::king_attacks(p.wksq) & ~Bitboards::king_attacks(p.bksq) &
+                    ~Bitboards::square_bb(p.psq);
+    while (king)
+      if (visit(Bitboards::pop_lsb(king), p.bksq, p.psq)) return WIN;
+
+    // Promotions are leaves, they either won already or lose the queen
+    const Square push = Bitboards::up(p.psq);
+    if (p.psq / 8 > 1 && push != p.wksq && push != p.bksq) {
+      if (visit(p.wksq, p.bksq, push)) return WIN;
+      const Square dbl = Bitboards::up(push);
+      if (p.psq / 8 == 6 && dbl != p.wksq && dbl != p.bksq && visit(p.wksq, p.bksq, dbl))
+        return WIN;
+    }
+  } else {
+    Bitboard king = Bitboards::king_attacks(p.bksq) &
+                    ~(Bitboards::king_attacks(p.wksq) |
+                      Bitboards::pawn_attacks_mask(p.psq, WHITE));
+    while (king)
+      if (visit(p.wksq, Bitboards::pop_lsb(king), p.psq)) return DRAW;
+  }
+
+  return unknown ? UNKNOWN : bad;
+}
+
+struct KPKTable {
+  std::array<uint32_t, KPK_SIZE / 32> wins{};
+
+  KPKTable() {
+    std::vector<Result> db(KPK_SIZE);
+    for (size_t i = 0; i < KPK_SIZE; ++i) db[i] = classify_leaf(decode(i));
+
+    // Each pass settles the positions one move further from a leaf
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (size_t i = 0; i < KPK_SIZE; ++i) {
+        if (db[i] != UNKNOWN) continue;
+        db[i] = classify(db, decode(i));
+        changed |= db[i] != UNKNOWN;
+      }
+    }
+
+    for (size_t i = 0; i < KPK_SIZE; ++i)
+      if (db[i] == WIN) wins[i / 32] |= 1u << (i % 32);
+  }
+};
+
+const KPKTable& table() {
+  static const KPKTable kpk;
+  return kpk;
+}
+
+}  // namespace
+
+void init() { table(); }
+
+bool probe_kpk(Square wksq, Square wpsq, Square bksq, Color stm) {
+  // Mirror onto files a-d
+  if (wpsq % 8 > 3) {
+    wksq = Square(wksq ^ 7);
+    wpsq = Square(wpsq ^ 7);
+    bksq = Square(bksq ^ 7);
+  }
+  const size_t idx = index(stm, bksq, wksq, wpsq);
+  return table().wins[idx / 32] >> (idx % 32) & 1;
+}
+
+}  // namespace Bitbases
@@ -0,0 +1,27 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "types.h"
+
+/**
+ * King and pawn versus king, solved by retrograde analysis at startup. One
+ * bit per position (white has the pawn, on files a-d, either side to
+ * move): 2 * 24 * 64 * 64 bits, 24 KB.
+ */
+namespace Bitbases {
+
+// Builds the KPK table, later calls are free. Probing builds it on first
+// use too, calling this up front just keeps that out of the first search.
+void init();
+
+// True when white wins with the given side to move. The pawn may be on any
+// file, the caller flips colours when black is the side with the pawn.
+bool probe_kpk(Square wksq, Square wpsq, Square bksq, Color stm);
+
+}  // namespace Bitbases
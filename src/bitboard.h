@@ -166,6 +166,23 @@ constexpr std::array<Bitboard, 64> make_black_pawn_moves_mask() {
   return table;
 }
 
+// Every square a slider on sq sees on an empty board
+constexpr std::array<Bitboard, 64> make_rays(bool diagonal) {
+  std::array<Bitboard, 64> table{};
+
+  for (int a = 0; a < 64; ++a) {
+    for (int b = 0; b < 64; ++b) {
+      const int dr = a / 8 - b / 8, df = a % 8 - b % 8;
+      const bool on_ray = diagonal ? (dr == df || dr == -df) : (dr == 0 || df == 0);
+      if (a != b && on_ray) table[static_cast<size_t>(a)] |= square_bb(Square(b));
+    }
+  }
+
+  return table;
+}
+
+constexpr auto rook_rays = make_rays(false);
+constexpr auto bishop_rays = make_rays(true);
 constexpr auto black_pawn_moves_mask = make_black_pawn_moves_mask();
 constexpr auto white_pawn_moves_mask = make_white_pawn_moves_mask();
 constexpr auto white_pawn_attacks_mask = make_white_pawn_attacks_mask();
@@ -8,22 +8,22 @@
 #include "board.h"
 
 #include "bitboard.h"
-#include "helpers.h"
 #include "move.h"
 #include "types.h"
 #include "zobrist.h"
 
 // ---------------- Constructor ----------------
 Board::Board()
-    : pieces({}),
+    : byType({}),
       occupancy{0, 0},
-      allPieces(0),
-      castling(),
-      fullMoveNumber(0),
+      hash(0),
+      checkers(0),
       kingSq({NO_SQUARE, NO_SQUARE}),
+      castling(NO_CASTLING),
       halfMoveClock(0),
       enPassant(Square::NO_SQUARE),
-      sideToMove(Color::WHITE) {}
+      sideToMove(Color::WHITE),
+      captured_piece(NO_PIECE) {}
 
 void Board::makeMove(const Move& m) {
   const Square from = m.from_sq(), to = m.to_sq();
@@ -31,13 +31,12 @@ void Board::makeMove(const Move& m) {
   const Piece pt = piece_on(from);
   const auto mt = m.type();
 
-  const CastlingRights old_cr = castling;
   const Square old_ep = enPassant;
 
   // XOR out the current state from the hash
   hash ^= Zobrist::sideToMove_key;
   if (old_ep != NO_SQUARE) hash ^= Zobrist::enPassant_keys[old_ep];
-  hash ^= Zobrist::castling_keys[PrintingHelpers::encode_castling(old_cr)];
+  hash ^= Zobrist::castling_keys[castling];
 
   const Bitboard from_bb = Bitboards::square_bb(from);
   const Bitboard to_bb = Bitboards::square_bb(to);
@@ -51,24 +50,22 @@ void Board::makeMove(const Move& m) {
 
   if (is_capture) {
     captured_piece = piece_on(to);
-    pieces[them][captured_piece] &= ~to_bb;
+    byType[captured_piece] ^= to_bb;
     occupancy[them] ^= to_bb;
-    allPieces ^= to_bb;
     hash ^=
         Zobrist::pieces_keys[Zobrist::piece_to_idx(them, captured_piece, to)];
   }
 
-  pieces[us][pt] ^= from_to_bb;
+  byType[pt] ^= from_to_bb;
   occupancy[us] ^= from_to_bb;
-  allPieces ^= from_to_bb;
   hash ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(us, pt, from)];
   hash ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(us, pt, to)];
 
   if (mt != MoveType::NORMAL) {
     switch (mt) {
       case MoveType::PROMOTION:
-        pieces[us][PAWN] &= ~to_bb;
-        pieces[us][m.promotion_type()] |= to_bb;
+        byType[PAWN] ^= to_bb;
+        byType[m.promotion_type()] |= to_bb;
         hash ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(us, pt, to)];
         hash ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(
             us, m.promotion_type(), to)];
@@ -79,9 +76,8 @@ void Board::makeMove(const Move& m) {
             (us == WHITE) ? Bitboards::down(to) : Bitboards::up(to);
         Bitboard capturedSq_bb = Bitboards::square_bb(capturedSq);
         captured_piece = PAWN;
-        pieces[them][PAWN] &= ~capturedSq_bb;
+        byType[PAWN] ^= capturedSq_bb;
         occupancy[them] ^= capturedSq_bb;
-        allPieces ^= capturedSq_bb;
         hash ^=
             Zobrist::pieces_keys[Zobrist::piece_to_idx(them, PAWN, capturedSq)];
         break;
@@ -98,9 +94,8 @@ void Board::makeMove(const Move& m) {
         }
         Bitboard rook_from_to =
             (Bitboards::square_bb(rookFrom) | Bitboards::square_bb(rookTo));
-        pieces[us][ROOK] ^= rook_from_to;
+        byType[ROOK] ^= rook_from_to;
         occupancy[us] ^= rook_from_to;
-        allPieces ^= rook_from_to;
         hash ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(us, ROOK, rookFrom)];
         hash ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(us, ROOK, rookTo)];
         break;
@@ -110,25 +105,8 @@ void Board::makeMove(const Move& m) {
     }
   }
 
-  if (pt == KING) {
-    if (us == WHITE) {
-      castling.whiteKingside = castling.whiteQueenside = false;
-      kingSq[WHITE] = to;
-    } else {
-      castling.blackKingside = castling.blackQueenside = false;
-      kingSq[BLACK] = to;
-    }
-  } else if (pt == ROOK) {
-    if (from == A1) castling.whiteQueenside = false;
-    else if (from == H1) castling.whiteKingside = false;
-    else if (from == A8) castling.blackQueenside = false;
-    else if (from == H8) castling.blackKingside = false;
-  } else if (captured_piece == ROOK) {
-    if (to == A1) castling.whiteQueenside = false;
-    else if (to == H1) castling.whiteKingside = false;
-    else if (to == A8) castling.blackQueenside = false;
-    else if (to == H8) castling.blackKingside = false;
-  }
+  if (pt == KING) kingSq[us] = to;
+  castling &= static_cast<uint8_t>(castling_mask[from] & castling_mask[to]);
 
   if (pt == PAWN) {
     if (us == WHITE) {
@@ -145,8 +123,218 @@ void Board::makeMove(const Move& m) {
   }
 
   if (enPassant != NO_SQUARE) hash ^= Zobrist::enPassant_keys[enPassant];
-  hash ^= Zobrist::castling_keys[PrintingHelpers::encode_castling(castling)];
+  hash ^= Zobrist::castling_keys[castling];
 
-  fullMoveNumber += us;
   sideToMove = them;
+
+  // Only the piece that moved, or a slider behind where it stood, can give
+  // check; the special moves get the full scan. Lines are tested through
+  // the small ray and between tables rather than magic lookups.
+  const Square ksq = kingSq[them];
+  if (mt != MoveType::NORMAL) {
+    checkers = attacks_to(ksq, us);
+    return;
+  }
+  const Bitboard all = allPieces();
+  const Bitboard rook_rays = Bitboards::rook_rays[ksq];
+  const Bitboard bishop_rays = Bitboards::bishop_rays[ksq];
+  Bitboard sliders = ((rook_rays & (byType[ROOK] | byType[QUEEN])) |
+                      (bishop_rays & (byType[BISHOP] | byType[QUEEN]))) &
+                     occupancy[us];
+  switch (pt) {
+    case PAWN: checkers = Bitboards::pawn_attacks_mask(ksq, them) & to_bb; break;
+    case KNIGHT: checkers = Bitboards::knight_attacks(ksq) & to_bb; break;
+    default: checkers = 0; break;
+  }
+  if (!((rook_rays | bishop_rays) & from_bb)) sliders &= to_bb;
+  while (sliders) {
+    const Square s = Bitboards::pop_lsb(sliders);
+    if (!(Bitboards::between(ksq, s) & all)) checkers |= Bitboards::square_bb(s);
+  }
+}
+
+// Mirrors the hash updates of makeMove, so the search can prefetch the
+// child's TT entry before paying for the full make
+uint64_t Board::key_after(const Move& m) const {
+  const Square from = m.from_sq(), to = m.to_sq();
+  const Color us = sideToMove, them = Color(BLACK - us);
+  const Piece pt = piece_on(from);
+  const auto mt = m.type();
+
+  uint64_t key = hash ^ Zobrist::sideToMove_key;
+  if (enPassant != NO_SQUARE) key ^= Zobrist::enPassant_keys[enPassant];
+
+  if (occupancy[them] & Bitboards::square_bb(to)) {
+    const Piece captured = piece_on(to);
+    key ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(them, captured, to)];
+  }
+
+  key ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(us, pt, from)];
+  key ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(us, pt, to)];
+
+  switch (mt) {
+    case MoveType::PROMOTION:
+      key ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(us, pt, to)];
+      key ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(us, m.promotion_type(), to)];
+      break;
+
+    case MoveType::EN_PASSANT: {
+      Square capturedSq = (us == WHITE) ? Bitboards::down(to) : Bitboards::up(to);
+      key ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(them, PAWN, capturedSq)];
+      break;
+    }
+
+    case MoveType::CASTLING: {
+      const bool kingside = to > from;
+      Square rookFrom = kingside ? (us == WHITE ? H1 : H8) : (us == WHITE ? A1 : A8);
+      Square rookTo = kingside ? (us == WHITE ? F1 : F8) : (us == WHITE ? D1 : D8);
+      key ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(us, ROOK, rookFrom)];
+      key ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(us, ROOK, rookTo)];
+      break;
+    }
+    default:
+      break;
+  }
+
+  key ^= Zobrist::castling_keys[castling];
+  key ^= Zobrist::castling_keys[castling & castling_mask[from] & castling_mask[to]];
+
+  if (pt == PAWN) {
+    const Bitboard from_bb = Bitboards::square_bb(from);
+    if (us == WHITE && (from_bb & Bitboards::RANK_2) &&
+        to == Bitboards::up(Bitboards::up(from)))
+      key ^= Zobrist::enPassant_keys[Bitboards::up(from)];
+    else if (us == BLACK && (from_bb & Bitboards::RANK_7) &&
+             to == Bitboards::down(Bitboards::down(from)))
+      key ^= Zobrist::enPassant_keys[Bitboards::down(from)];
+  }
+
+  return key;
+}
+
+CheckInfo Board::check_info() const {
+  const Color us = sideToMove, them = Color(BLACK - us);
+  const Square ksq = kingSq[them];
+  const Bitboard all = allPieces();
+
+  CheckInfo ci;
+  ci.squares[PAWN] = Bitboards::pawn_attacks_mask(ksq, them);
+  ci.squares[KNIGHT] = Bitboards::knight_attacks(ksq);
+  ci.squares[BISHOP] = Bitboards::bishop_attacks(ksq, all);
+  ci.squares[ROOK] = Bitboards::rook_attacks(ksq, all);
+  ci.squares[QUEEN] = ci.squares[BISHOP] | ci.squares[ROOK];
+  ci.squares[KING] = 0;
+
+  // Our sliders that would see the king on an empty board, and what stands
+  // in their way
+  ci.blockers = 0;
+  Bitboard snipers =
+      ((Bitboards::rook_attacks(ksq, 0) & (byType[ROOK] | byType[QUEEN])) |
+       (Bitboards::bishop_attacks(ksq, 0) & (byType[BISHOP] | byType[QUEEN]))) &
+      occupancy[us];
+  while (snipers) {
+    const Bitboard between = Bitboards::between(ksq, Bitboards::pop_lsb(snipers)) & all;
+    if (between && !(between & (between - 1))) ci.blockers |= between & occupancy[us];
+  }
+  return ci;
+}
+
+bool Board::gives_check(const Move& m, const CheckInfo& ci) const {
+  const Square from = m.from_sq(), to = m.to_sq();
+  const Color us = sideToMove;
+  const Square ksq = kingSq[BLACK - us];
+  const Bitboard from_bb = Bitboards::square_bb(from);
+  const Bitboard to_bb = Bitboards::square_bb(to);
+  const auto mt = m.type();
+
+  // Castling moves two pieces, just look at the board it leaves
+  if (mt == MoveType::CASTLING) {
+    const bool kingside = to > from;
+    const Square rookFrom = kingside ? (us == WHITE ? H1 : H8) : (us == WHITE ? A1 : A8);
+    const Square rookTo = kingside ? (us == WHITE ? F1 : F8) : (us == WHITE ? D1 : D8);
+    const Bitboard rook_from_to = Bitboards::square_bb(rookFrom) | Bitboards::square_bb(rookTo);
+    const Bitboard occ = allPieces() ^ from_bb ^ to_bb ^ rook_from_to;
+    const Bitboard ours = occupancy[us] ^ from_bb ^ to_bb ^ rook_from_to;
+    return (Bitboards::rook_attacks(ksq, occ) & ((byType[ROOK] ^ rook_from_to) | byType[QUEEN]) &
+            ours) ||
+           (Bitboards::bishop_attacks(ksq, occ) & (byType[BISHOP] | byType[QUEEN]) & ours);
+  }
+
+  // Direct check; the piece cannot have been blocking its own line
+  if (mt != MoveType::PROMOTION && (ci.squares[piece_on(from)] & to_bb)) return true;
+
+  // Discovered check, only possible when leaving a blocking square (or
+  // removing the pawn taken en passant), checked against the real board
+  if ((ci.blockers & from_bb) || mt == MoveType::EN_PASSANT) {
+    Bitboard occ = (allPieces() ^ from_bb) | to_bb;
+    if (mt == MoveType::EN_PASSANT)
+      occ ^= Bitboards::square_bb(us == WHITE ? Bitboards::down(to) : Bitboards::up(to));
+    const Bitboard ours = occupancy[us] & ~from_bb;
+    if ((Bitboards::rook_attacks(ksq, occ) & (byType[ROOK] | byType[QUEEN]) & ours) ||
+        (Bitboards::bishop_attacks(ksq, occ) & (byType[BISHOP] | byType[QUEEN]) & ours))
+      return true;
+  }
+
+  if (mt != MoveType::PROMOTION) return false;
+  const Bitboard occ = allPieces() ^ from_bb;
+  const Bitboard king_bb = Bitboards::square_bb(ksq);
+  switch (m.promotion_type()) {
+    case KNIGHT: return Bitboards::knight_attacks(to) & king_bb;
+    case BISHOP: return Bitboards::bishop_attacks(to, occ) & king_bb;
+    case ROOK: return Bitboards::rook_attacks(to, occ) & king_bb;
+    default: return Bitboards::queen_attacks(to, occ) & king_bb;
+  }
+}
+
+bool Board::is_pseudo_legal(const Move& m) const {
+  if (m.raw() == EMPTY_MOVE) return false;
+
+  const Square from = m.from_sq(), to = m.to_sq();
+  const Color us = sideToMove, them = Color(BLACK - us);
+  const Bitboard from_bb = Bitboards::square_bb(from);
+  const Bitboard to_bb = Bitboards::square_bb(to);
+  const Bitboard all = allPieces();
+  if (!(occupancy[us] & from_bb) || (occupancy[us] & to_bb)) return false;
+
+  const Piece pt = piece_on(from);
+  const auto mt = m.type();
+
+  // Exactly what generate_castling_moves asks for
+  if (mt == MoveType::CASTLING) {
+    const bool white = us == WHITE, kingside = to == (white ? G1 : G8);
+    if (pt != KING || checkers || from != (white ? E1 : E8) ||
+        (!kingside && to != (white ? C1 : C8)))
+      return false;
+    const CastlingRight right = white ? (kingside ? WHITE_KINGSIDE : WHITE_QUEENSIDE)
+                                      : (kingside ? BLACK_KINGSIDE : BLACK_QUEENSIDE);
+    const Bitboard empty = white ? (kingside ? Bitboards::WK_EMPTY : Bitboards::WQ_EMPTY)
+                                 : (kingside ? Bitboards::BK_EMPTY : Bitboards::BQ_EMPTY);
+    const Square through = kingside ? (white ? F1 : F8) : (white ? D1 : D8);
+    return can_castle(right) && !(all & empty) && !attacks_to(through, them) &&
+           !attacks_to(to, them);
+  }
+
+  if (pt == PAWN) {
+    const Bitboard last_rank = us == WHITE ? Bitboards::RANK_8 : Bitboards::RANK_1;
+    if (mt == MoveType::EN_PASSANT)
+      return to == enPassant && (Bitboards::pawn_attacks_mask(from, us) & to_bb);
+    // Promotions, and only promotions, reach the last rank
+    if ((mt == MoveType::PROMOTION) != bool(to_bb & last_rank)) return false;
+
+    if (Bitboards::pawn_attacks_mask(from, us) & to_bb) return occupancy[them] & to_bb;
+    const Bitboard push = us == WHITE ? Bitboards::bb_up(from_bb) : Bitboards::bb_down(from_bb);
+    if (push & ~all & to_bb) return true;
+    const Bitboard start_rank = us == WHITE ? Bitboards::RANK_2 : Bitboards::RANK_7;
+    const Bitboard double_push = us == WHITE ? Bitboards::bb_up(push) : Bitboards::bb_down(push);
+    return (from_bb & start_rank) && !(push & all) && (double_push & ~all & to_bb);
+  }
+
+  if (mt != MoveType::NORMAL) return false;
+  switch (pt) {
+    case KNIGHT: return Bitboards::knight_attacks(from) & to_bb;
+    case BISHOP: return Bitboards::bishop_attacks(from, all) & to_bb;
+    case ROOK: return Bitboards::rook_attacks(from, all) & to_bb;
+    case QUEEN: return Bitboards::queen_attacks(from, all) & to_bb;
+    default: return Bitboards::king_attacks(from) & to_bb;
+  }
 }
@@ -15,25 +15,51 @@
 #include "move.h"
 #include "types.h"
 
-// I made some tests with an enum : uint8_t
-// but this implementation was much faster
-// apparently so I will keep it like this
-struct CastlingRights {
-  bool whiteKingside = false;
-  bool whiteQueenside = false;
-  bool blackKingside = false;
-  bool blackQueenside = false;
-
-  void clear() {
-    whiteKingside = whiteQueenside = blackKingside = blackQueenside = false;
-  }
+// Rights that survive a move from or to each square: moving the king or a
+// rook, or capturing a rook, gives up the matching ones
+constexpr std::array<uint8_t, 64> castling_mask = [] {
+  std::array<uint8_t, 64> mask{};
+  mask.fill(ANY_CASTLING);
+  mask[E1] = ANY_CASTLING & ~(WHITE_KINGSIDE | WHITE_QUEENSIDE);
+  mask[H1] = ANY_CASTLING & ~WHITE_KINGSIDE;
+  mask[A1] = ANY_CASTLING & ~WHITE_QUEENSIDE;
+  mask[E8] = ANY_CASTLING & ~(BLACK_KINGSIDE | BLACK_QUEENSIDE);
+  mask[H8] = ANY_CASTLING & ~BLACK_KINGSIDE;
+  mask[A8] = ANY_CASTLING & ~BLACK_QUEENSIDE;
+  return mask;
+}();
+
+// What a node needs to tell whether its moves give check, see check_info()
+struct CheckInfo {
+  std::array<Bitboard, 6> squares;  // [pieceType], where it would attack their king
+  Bitboard blockers;                // our pieces alone between their king and our slider
 };
 
+/**
+ * Copy-make position. Pieces are kept per type for both colours plus one
+ * occupancy per colour, a piece of one side being their intersection, so
+ * the board is 8 bitboards, the hash, the pieces giving check and a word
+ * of small state: 88 bytes. The full move number is not needed to play
+ * and lives with whoever reads or writes it (FEN, packed records).
+ *
+ * That is two cache lines per copy, not one. Fitting in 64 bytes would
+ * take two of the ten words out: deriving an occupancy or the kings
+ * puts work on every pieces() or allPieces() call, and the hash and
+ * checkers are read at every node. Anything from 65 to 128 bytes costs
+ * the same two lines, so the small state is not squeezed either.
+ */
 struct Board {
   Board();
   Board(const Board& other) = default;
 
-  void updateOccupancy();
+  Bitboard pieces(Color c, Piece pt) const { return byType[pt] & occupancy[c]; }
+  Bitboard allPieces() const { return occupancy[WHITE] | occupancy[BLACK]; }
+  bool can_castle(uint8_t rights) const { return castling & rights; }
+
+  // Adds a piece without touching the hash, for setting up positions
+  void put_piece(Color c, Piece pt, Square sq);
+  // Recomputes checkers, for positions set up by hand (makeMove keeps it)
+  void update_checkers();
 
   Bitboard attacks_to(Square sq, Color attacker_color) const;
 
@@ -44,57 +70,65 @@ struct Board {
   Piece piece_on(Square sq) const;
 
   void makeMove(const Move& m);
+  // Hash the board will have after makeMove(m), without making it
+  uint64_t key_after(const Move& m) const;
+  // Whether the move generator could produce m here: our piece moves that
+  // way with nothing in its path, and the pawn and castling rules hold.
+  // Vets moves from elsewhere (TT, killers) before isLegalMove, which
+  // expects pseudo-legal input.
+  bool is_pseudo_legal(const Move& m) const;
   inline bool isLegalMove(const Move& m) const;
-  inline bool moveExists(const Move& m) const;
 
-  std::array<std::array<Bitboard, 6>, 2> pieces;  // [color][pieceType]
-  std::array<Bitboard, 2> occupancy;              // white/black
+  // Computed once per node, shared by the gives_check of all its moves
+  CheckInfo check_info() const;
+  // Whether legal move m checks the opponent, without making it
+  bool gives_check(const Move& m, const CheckInfo& ci) const;
+  bool gives_check(const Move& m) const { return gives_check(m, check_info()); }
+
+  std::array<Bitboard, 6> byType;     // [pieceType], both colours
+  std::array<Bitboard, 2> occupancy;  // white/black
   uint64_t hash;
-  Bitboard allPieces;                             // all occupied squares
-  CastlingRights castling;                        // castling rights flags
-  uint16_t fullMoveNumber;
+  Bitboard checkers;  // enemy pieces attacking the king of the side to move
   std::array<Square, 2> kingSq;
+  uint8_t castling;  // CastlingRight bits
   uint8_t halfMoveClock;
   Square enPassant = NO_SQUARE;  // en passant target
   Color sideToMove;
   Piece captured_piece;
 };
 
-inline void Board::updateOccupancy() {
-  occupancy[WHITE] = pieces[WHITE][PAWN] | pieces[WHITE][KNIGHT] |
-                     pieces[WHITE][BISHOP] | pieces[WHITE][ROOK] |
-                     pieces[WHITE][QUEEN] | pieces[WHITE][KING];
+static_assert(sizeof(Board) == 88, "Board is copied at every node, keep it small");
 
-  occupancy[BLACK] = pieces[BLACK][PAWN] | pieces[BLACK][KNIGHT] |
-                     pieces[BLACK][BISHOP] | pieces[BLACK][ROOK] |
-                     pieces[BLACK][QUEEN] | pieces[BLACK][KING];
+inline void Board::put_piece(Color c, Piece pt, Square sq) {
+  const Bitboard bb = Bitboards::square_bb(sq);
+  byType[pt] |= bb;
+  occupancy[c] |= bb;
+  if (pt == KING) kingSq[c] = sq;
+}
 
-  allPieces = occupancy[WHITE] | occupancy[BLACK];
-  kingSq = {static_cast<Square>(std::countr_zero(pieces[WHITE][KING])),
-            static_cast<Square>(std::countr_zero(pieces[BLACK][KING]))};
+inline void Board::update_checkers() {
+  const Square ksq = kingSq[sideToMove];
+  checkers = ksq == NO_SQUARE ? 0 : attacks_to(ksq, Color(BLACK - sideToMove));
 }
 
 inline Bitboard Board::attacks_to(Square sq, Color attacker_color) const {
+  const Bitboard all = allPieces();
   Bitboard attackers = 0;
 
   attackers |= Bitboards::pawn_attacks_mask(
                    sq, static_cast<Color>(BLACK - attacker_color)) &
-               pieces[attacker_color][PAWN];
-  attackers |= Bitboards::knight_attacks(sq) & pieces[attacker_color][KNIGHT];
-  attackers |= Bitboards::king_attacks(sq) & pieces[attacker_color][KING];
-  attackers |= Bitboards::bishop_attacks(sq, allPieces) &
-               (pieces[attacker_color][BISHOP] | pieces[attacker_color][QUEEN]);
-  attackers |= Bitboards::rook_attacks(sq, allPieces) &
-               (pieces[attacker_color][ROOK] | pieces[attacker_color][QUEEN]);
-
-  return attackers;
+               byType[PAWN];
+  attackers |= Bitboards::knight_attacks(sq) & byType[KNIGHT];
+  attackers |= Bitboards::king_attacks(sq) & byType[KING];
+  attackers |= Bitboards::bishop_attacks(sq, all) & (byType[BISHOP] | byType[QUEEN]);
+  attackers |= Bitboards::rook_attacks(sq, all) & (byType[ROOK] | byType[QUEEN]);
+
+  return attackers & occupancy[attacker_color];
 }
 
 inline __attribute__((always_inline)) bool Board::is_in_check(
     Color c) const noexcept {
-  // Bitboard king_bb = pieces[c][KING];
-  //
-  // Square kingSquare = static_cast<Square>(__builtin_ctzll(king_bb));
+  if (c == sideToMove) return checkers != 0;
   Color enemy = Color(BLACK - c);
   return attacks_to(kingSq[c], enemy) != 0;
 }
@@ -109,50 +143,40 @@ inline Color Board::color_on(Square sq) const {
 inline Piece Board::piece_on(Square sq) const {
   Bitboard sq_bb = Bitboards::square_bb(sq);
 
-  for (size_t color = WHITE; color <= BLACK; ++color) {
-    for (size_t pt = PAWN; pt <= KING; ++pt) {
-      if (pieces[color][pt] & sq_bb) {
-        return static_cast<Piece>(pt);
-      }
+  for (size_t pt = PAWN; pt <= KING; ++pt) {
+    if (byType[pt] & sq_bb) {
+      return static_cast<Piece>(pt);
     }
   }
   return NO_PIECE;
 }
 
-inline bool Board::moveExists(const Move& m) const {
-  auto to = m.to_sq();
-  return ((m.from_sq() & occupancy[sideToMove]) &&
-          ((to & ~allPieces) || (to & occupancy[BLACK - sideToMove])));
-}
-
 inline bool Board::isLegalMove(const Move& m) const {
   const Square from = m.from_sq(), to = m.to_sq();
   const Color us = sideToMove, them = Color(BLACK - us);
-  const Piece pt = piece_on(from);
   const auto mt = m.type();
 
   const Bitboard from_bb = Bitboards::square_bb(from);
   const Bitboard to_bb = Bitboards::square_bb(to);
   const Bitboard from_to_bb = (from_bb | to_bb);
 
-  // Copies we will mutate to simulate the move
-  auto pcs = pieces;             // [color][piece]
-  auto occ = occupancy;          // [color]
-  Bitboard occ_all = allPieces;  // union
-
-  // handle capture (normal capture)
-  const Bitboard is_capture = (occ[them] & to_bb);
-  if (is_capture) {
-    Piece capturedP = piece_on(to);
-    pcs[them][capturedP] &= ~to_bb;
-    occ[them] ^= to_bb;
-    occ_all ^= to_bb;
+  // Out of check, a piece that leaves no enemy slider a line to our king
+  // cannot uncover it
+  if (!checkers && from != kingSq[us] && mt != MoveType::EN_PASSANT) {
+    const Bitboard rook_rays = Bitboards::rook_rays[kingSq[us]];
+    const Bitboard bishop_rays = Bitboards::bishop_rays[kingSq[us]];
+    if (!((rook_rays & from_bb) &&
+          (rook_rays & (byType[ROOK] | byType[QUEEN]) & occupancy[them])) &&
+        !((bishop_rays & from_bb) &&
+          (bishop_rays & (byType[BISHOP] | byType[QUEEN]) & occupancy[them])))
+      return true;
   }
 
-  // move the piece
-  pcs[us][pt] ^= from_to_bb;
+  // Only occupancies need simulating: enemy pieces are byType & occ[them],
+  // so a captured piece drops out of its type along with its colour
+  auto occ = occupancy;
+  occ[them] &= ~to_bb;
   occ[us] ^= from_to_bb;
-  occ_all ^= from_to_bb;
 
   // handle special moves
   if (mt != MoveType::NORMAL) [[unlikely]] {
@@ -160,10 +184,7 @@ inline bool Board::isLegalMove(const Move& m) const {
       case MoveType::EN_PASSANT: {
         Square capturedSq =
             (us == WHITE) ? Bitboards::down(to) : Bitboards::up(to);
-        Bitboard capturedSq_bb = Bitboards::square_bb(capturedSq);
-        pcs[them][PAWN] &= ~capturedSq_bb;
-        occ[them] ^= capturedSq_bb;
-        occ_all ^= capturedSq_bb;
+        occ[them] ^= Bitboards::square_bb(capturedSq);
         break;
       }
       case MoveType::CASTLING: {
@@ -175,11 +196,7 @@ inline bool Board::isLegalMove(const Move& m) const {
           rookFrom = (us == WHITE) ? Square::A1 : Square::A8;
           rookTo = (us == WHITE) ? Square::D1 : Square::D8;
         }
-        Bitboard r_bb =
-            (Bitboards::square_bb(rookFrom) | Bitboards::square_bb(rookTo));
-        pcs[us][ROOK] ^= r_bb;
-        occ[us] ^= r_bb;
-        occ_all ^= r_bb;
+        occ[us] ^= Bitboards::square_bb(rookFrom) | Bitboards::square_bb(rookTo);
         break;
       }
       default:
@@ -187,26 +204,25 @@ inline bool Board::isLegalMove(const Move& m) const {
     }
   }
 
-  Square king_sq = kingSq[us];
-  if (pt == KING) king_sq = to;
+  const Bitboard occ_all = occ[WHITE] | occ[BLACK];
+  const Square king_sq = from == kingSq[us] ? to : kingSq[us];
 
   // Bishop/Queen diagonal
-  if (Bitboards::bishop_attacks(king_sq, occ_all) &
-      (pcs[them][BISHOP] | pcs[them][QUEEN]))
+  if (Bitboards::bishop_attacks(king_sq, occ_all) & (byType[BISHOP] | byType[QUEEN]) &
+      occ[them])
     return false;
 
   // Rook/Queen straight
-  if (Bitboards::rook_attacks(king_sq, occ_all) &
-      (pcs[them][ROOK] | pcs[them][QUEEN]))
+  if (Bitboards::rook_attacks(king_sq, occ_all) & (byType[ROOK] | byType[QUEEN]) & occ[them])
     return false;
 
   // Knight attackers
-  if (Bitboards::knight_attacks(king_sq) & pcs[them][KNIGHT]) return false;
+  if (Bitboards::knight_attacks(king_sq) & byType[KNIGHT] & occ[them]) return false;
 
   // Pawn attackers
-  if (Bitboards::pawn_attacks_mask(king_sq, us) & pcs[them][PAWN]) return false;
+  if (Bitboards::pawn_attacks_mask(king_sq, us) & byType[PAWN] & occ[them]) return false;
 
-  if (Bitboards::king_attacks(king_sq) & pcs[them][KING]) return false;
+  if (Bitboards::king_attacks(king_sq) & byType[KING] & occ[them]) return false;
 
   return true;
 }
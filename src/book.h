@@ -0,0 +1,73 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "move.h"
+
+namespace Polyglot {
+
+// Key of the start position, as published with the Polyglot format
+constexpr uint64_t STARTPOS_KEY = 0x463B96181691FC9CULL;
+
+// Polyglot's own hash of the position, independent of Zobrist::
+uint64_t key(const Board& board);
+
+// One 16 byte record as stored (big endian) in a .bin file
+struct Entry {
+  uint64_t key;
+  uint16_t move;
+  uint16_t weight;
+  uint32_t learn;
+};
+
+// Polyglot move -> our move, EMPTY_MOVE if it is not legal here
+Move decode_move(const Board& board, uint16_t pg_move);
+uint16_t encode_move(const Move& m);
+
+}  // namespace Polyglot
+
+/**
+ * Read only view of a Polyglot book. The file is mapped, not read, and the
+ * entries are sorted by key, so a probe is a binary search touching a
+ * handful of pages.
+ */
+class OpeningBook {
+ public:
+  OpeningBook() = default;
+  ~OpeningBook() { close(); }
+
+  OpeningBook(const OpeningBook&) = delete;
+  OpeningBook& operator=(const OpeningBook&) = delete;
+
+  bool open(const std::string& path);
+  void close();
+  bool is_open() const { return data != nullptr; }
+  size_t size() const { return count; }
+
+  // All entries for this position, best weight first
+  std::vector<Polyglot::Entry> entries(const Board& board) const;
+
+  // Highest weight move when best is set, otherwise picked at random in
+  // proportion to the weights. EMPTY_MOVE when out of book.
+  Move probe(const Board& board, bool best);
+
+ private:
+  Polyglot::Entry entry_at(size_t i) const;
+
+  const unsigned char* data = nullptr;
+  size_t count = 0;
+  size_t mapped_bytes = 0;
+  std::mt19937_64 rng{std::random_device{}()};
+};
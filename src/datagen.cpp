@@ -0,0 +1,131 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "datagen.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+
+#include "fen.h"
+#include "movegen.h"
+#include "packed.h"
+
+namespace Datagen {
+
+namespace {
+
+// Scores this large are mates or table wins, not something to learn from
+constexpr int MAX_SAMPLE_SCORE = FoChess::TB_WIN_SCORE - FoChess::MAX_PLY;
+
+// Random moves from the start position, retried until the game is still on
+Board random_opening(std::mt19937_64& rng, int plies, std::vector<uint64_t>& history) {
+  while (true) {
+    Board board = FEN::parse();
+    history.clear();
+
+    bool alive = true;
+    for (int i = 0; i < plies && alive; ++i) {
+      std::array<Move, MAX_MOVES> moves;
+      const size_t n = MoveGen::generate_all(board, moves);
+      alive = n > 0;
+      if (!alive) break;
+      history.push_back(board.hash);
+      board.makeMove(moves[rng() % n]);
+    }
+
+    std::string reason;
+    if (alive && Match::adjudicate(board, history, reason) == Match::ONGOING) return board;
+  }
+}
+
+bool is_quiet(const Board& board, const Move& best, int score) {
+  return !board.is_in_check(board.sideToMove) && best.type() != PROMOTION &&
+         best.type() != EN_PASSANT && board.piece_on(best.to_sq()) == NO_PIECE &&
+         std::abs(score) < MAX_SAMPLE_SCORE;
+}
+
+}  // namespace
+
+GameRecord play_game(FoChess::SearchInstance& search, TranspositionTable& tt,
+                     std::mt19937_64& rng, const Options& options) {
+  FoChess::ScopedSearch bind(search);
+  search.state.node_limit = options.nodes;
+  const int depth = options.depth > 0 ? options.depth : FoChess::MAX_PLY - 1;
+
+  std::vector<uint64_t> history;
+  Board board = random_opening(rng, options.random_plies, history);
+  tt.clear();
+
+  GameRecord game;
+  std::string reason;
+  int win_count = 0, last_score = 0;
+
+  for (int ply = 0; (game.result = Match::adjudicate(board, history, reason)) == Match::ONGOING;
+       ++ply) {
+    if (ply >= options.max_plies) {
+      game.result = Match::DRAWN;
+      break;
+    }
+
+    FoChess::iterative_deepening(depth, board, tt);
+    const Move best = search.stats.best_move.load(std::memory_order_relaxed);
+    const int score = search.stats.best_root_score.load(std::memory_order_relaxed);
+    const int white_score = board.sideToMove == WHITE ? score : -score;
+
+    if (is_quiet(board, best, score))
+      game.samples.push_back(
+          {board, white_score, best, static_cast<uint16_t>(1 + history.size() / 2)});
+
+    // Consecutive plies come from alternating sides, so both agree
+    win_count = std::abs(white_score) >= options.win_cp &&
+                        (win_count == 0 || (white_score > 0) == (last_score > 0))
+                    ? win_count + 1
+                    : 0;
+    last_score = white_score;
+    if (win_count >= options.win_plies) {
+      game.result = white_score > 0 ? Match::WHITE_WINS : Match::BLACK_WINS;
+      break;
+    }
+
+    history.push_back(board.hash);
+    board.makeMove(best);
+  }
+
+  search.state.node_limit = 0;
+  return game;
+}
+
+std::string format(const GameRecord& game) {
+  const char* result = game.result == Match::WHITE_WINS   ? "1.0"
+                       : game.result == Match::BLACK_WINS ? "0.0"
+                                                          : "0.5";
+  std::string out;
+  for (const Sample& s : game.samples) {
+    FEN::append(s.board, out, s.fullmove);
+    out += " | " + std::to_string(s.score) + " | " + result + "\n";
+  }
+  return out;
+}
+
+std::string format_packed(const GameRecord& game) {
+  const uint8_t result = game.result == Match::WHITE_WINS   ? PackedBoard::RESULT_WIN
+                         : game.result == Match::BLACK_WINS ? PackedBoard::RESULT_LOSS
+                                                            : PackedBoard::RESULT_DRAW;
+  std::string out(game.samples.size() * sizeof(PackedBoard), '\0');
+  for (size_t i = 0; i < game.samples.size(); ++i) {
+    const Sample& s = game.samples[i];
+    const PackedBoard p = PackedBoard::encode(
+        s.board, static_cast<int16_t>(std::clamp(s.score, -32767, 32767)), s.move, result,
+        s.fullmove);
+    std::memcpy(out.data() + i * sizeof(PackedBoard), &p, sizeof(PackedBoard));
+  }
+  return out;
+}
+
+}  // namespace Datagen
@@ -0,0 +1,63 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "match.h"
+#include "move.h"
+#include "search.h"
+#include "tt.h"
+
+/**
+ * Training data from self-play. Games start with a few random moves and
+ * continue with node (or depth) limited searches; every quiet position
+ * along the way is kept with its search score and, once the game is over,
+ * its result. Scores and results are from white's point of view.
+ */
+namespace Datagen {
+
+struct Options {
+  uint64_t nodes = 5000;  // per move, 0 to search by depth only
+  int depth = 0;          // per move, 0 for no depth limit
+  int random_plies = 8;
+  int max_plies = 400;
+  // A game is over once both sides agree on at least this score
+  int win_cp = 2000;
+  int win_plies = 4;
+};
+
+struct Sample {
+  Board board;
+  int score;
+  Move move;
+  uint16_t fullmove;
+};
+
+struct GameRecord {
+  std::vector<Sample> samples;
+  Match::GameResult result = Match::ONGOING;
+};
+
+// Plays one game with the given instance bound to the calling thread
+GameRecord play_game(FoChess::SearchInstance& search, TranspositionTable& tt,
+                     std::mt19937_64& rng, const Options& options);
+
+// One "fen | score | result" line per sample, the result being 1.0, 0.5
+// or 0.0
+std::string format(const GameRecord& game);
+
+// The same as PackedBoard records, with the best move
+std::string format_packed(const GameRecord& game);
+
+}  // namespace Datagen
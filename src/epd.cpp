@@ -0,0 +1,169 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "epd.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "fen.h"
+#include "helpers.h"
+
+namespace EPD {
+
+namespace {
+
+std::string trim(const std::string& s) {
+  const size_t begin = s.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) return "";
+  return s.substr(begin, s.find_last_not_of(" \t\r\n") - begin + 1);
+}
+
+std::vector<std::string> split(const std::string& s) {
+  std::istringstream ss(s);
+  std::vector<std::string> words;
+  std::string w;
+  while (ss >> w) words.push_back(w);
+  return words;
+}
+
+std::string unquote(const std::string& s) {
+  if (s.size() >= 2 && s.front() == '"' && s.back() == '"') return s.substr(1, s.size() - 2);
+  return s;
+}
+
+const std::string* find_op(const Position& pos, const std::string& opcode) {
+  for (const auto& [code, operands] : pos.ops)
+    if (code == opcode) return &operands;
+  return nullptr;
+}
+
+std::vector<Move> to_moves(const std::vector<std::string>& san, const Board& board) {
+  std::vector<Move> moves;
+  for (const std::string& s : san) {
+    const Move m = PrintingHelpers::san_to_move(s, board);
+    if (m.raw() != EMPTY_MOVE) moves.push_back(m);
+  }
+  return moves;
+}
+
+}  // namespace
+
+bool parse(const std::string& line, Position& pos) {
+  const std::string text = trim(line);
+  if (text.empty() || text[0] == '#') return false;
+
+  std::istringstream ss(text);
+  std::string fields[4];
+  for (std::string& f : fields)
+    if (!(ss >> f)) return false;
+
+  pos = Position();
+  std::string rest;
+  std::getline(ss, rest);
+
+  // Operations end at a ';' outside quotes
+  std::string op;
+  bool quoted = false;
+  for (char c : rest + ";") {
+    if (c == '"') quoted = !quoted;
+    if (c != ';' || quoted) {
+      op += c;
+      continue;
+    }
+    op = trim(op);
+    if (!op.empty()) {
+      const size_t space = op.find_first_of(" \t");
+      if (space == std::string::npos) pos.ops.emplace_back(op, "");
+      else pos.ops.emplace_back(op.substr(0, space), trim(op.substr(space)));
+    }
+    op.clear();
+  }
+
+  for (const auto& [code, operands] : pos.ops) {
+    if (code == "bm") pos.best_moves = split(operands);
+    else if (code == "am") pos.avoid_moves = split(operands);
+    else if (code == "id") pos.id = unquote(operands);
+  }
+
+  const std::string* hmvc = find_op(pos, "hmvc");
+  const std::string* fmvn = find_op(pos, "fmvn");
+  pos.fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3] + " " +
+            (hmvc ? *hmvc : "0") + " " + (fmvn ? *fmvn : "1");
+  return true;
+}
+
+std::string annotate(const Position& pos, const Result& result) {
+  const Board board = FEN::parse(pos.fen);
+  std::string out = FEN::to_fen(board);
+
+  static const char* replaced[] = {"acd", "acn", "acs", "ce", "dm", "pm", "c0", "c1"};
+  for (const auto& [code, operands] : pos.ops) {
+    if (std::find(std::begin(replaced), std::end(replaced), code) != std::end(replaced))
+      continue;
+    out += " " + code + (operands.empty() ? "" : " " + operands) + ";";
+  }
+
+  out += " acd " + std::to_string(result.depth) + ";";
+  out += " acn " + std::to_string(result.nodes) + ";";
+  out += " acs " + std::to_string(result.time_ms / 1000) + ";";
+  if (FoChess::is_mate_score(result.score))
+    out += " dm " + std::to_string(FoChess::mate_in(result.score)) + ";";
+  else
+    out += " ce " + std::to_string(result.score) + ";";
+  if (result.move.raw() != EMPTY_MOVE)
+    out += " pm " + PrintingHelpers::move_to_san(result.move, board) + ";";
+
+  if (!pos.best_moves.empty() || !pos.avoid_moves.empty()) {
+    out += std::string(" c0 \"") + (result.solved ? "solved" : "failed") + "\";";
+    if (result.solved)
+      out += " c1 \"" + std::to_string(result.solve_ms) + " ms " +
+             std::to_string(result.solve_nodes) + " nodes\";";
+  }
+  return out;
+}
+
+Result solve(const Position& pos, FoChess::SearchInstance& search, TranspositionTable& tt,
+             int max_depth, int64_t movetime_ms) {
+  FoChess::ScopedSearch bind(search);
+  Board board = FEN::parse(pos.fen);
+
+  const std::vector<Move> best = to_moves(pos.best_moves, board);
+  const std::vector<Move> avoid = to_moves(pos.avoid_moves, board);
+  auto solves = [&](Move m) {
+    if (best.empty() && avoid.empty()) return false;
+    return (best.empty() || std::find(best.begin(), best.end(), m) != best.end()) &&
+           std::find(avoid.begin(), avoid.end(), m) == avoid.end();
+  };
+
+  Result result;
+  bool solving = false;
+  search.state.on_iteration = [&] {
+    const Move m = search.stats.best_move.load(std::memory_order_relaxed);
+    if (!solves(m)) {
+      solving = false;
+    } else if (!solving) {
+      solving = true;
+      result.solve_ms = search.stats.elapsed_ms(search.state);
+      result.solve_nodes = search.stats.nodes();
+    }
+  };
+
+  tt.clear();
+  FoChess::iterative_deepening(max_depth, board, tt, movetime_ms);
+  search.state.on_iteration = nullptr;
+
+  result.move = search.stats.best_move.load(std::memory_order_relaxed);
+  result.score = search.stats.best_root_score.load(std::memory_order_relaxed);
+  result.depth = search.stats.highest_depth.load(std::memory_order_relaxed);
+  result.nodes = search.stats.nodes();
+  result.time_ms = search.stats.elapsed_ms(search.state);
+  result.solved = solving && solves(result.move);
+  return result;
+}
+
+}  // namespace EPD
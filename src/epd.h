@@ -0,0 +1,60 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "move.h"
+#include "search.h"
+#include "tt.h"
+
+/**
+ * Test suites in EPD: four FEN fields followed by "opcode operands;"
+ * operations. bm lists the moves that solve a position, am the ones that
+ * must be avoided, both in SAN.
+ */
+namespace EPD {
+
+struct Position {
+  std::string fen;
+  std::string id;
+  std::vector<std::string> best_moves;
+  std::vector<std::string> avoid_moves;
+  // Every operation as read, operands unparsed
+  std::vector<std::pair<std::string, std::string>> ops;
+};
+
+struct Result {
+  Move move;
+  int score = 0;
+  int depth = 0;
+  uint64_t nodes = 0;
+  int64_t time_ms = 0;
+  bool solved = false;
+  // Iteration from which the best move solved the position and kept doing
+  // so until the end, only meaningful when solved
+  int64_t solve_ms = 0;
+  uint64_t solve_nodes = 0;
+};
+
+// False for blank lines, comments and lines without four FEN fields
+bool parse(const std::string& line, Position& pos);
+
+// The position with the engine's answer added as acd, acn, acs, ce and pm
+// (replacing any it had), plus a c0 comment saying whether it was solved
+std::string annotate(const Position& pos, const Result& result);
+
+// Searches pos with the given instance bound to the calling thread, until
+// max_depth or movetime_ms, whichever comes first
+Result solve(const Position& pos, FoChess::SearchInstance& search, TranspositionTable& tt,
+             int max_depth, int64_t movetime_ms);
+
+}  // namespace EPD
@@ -0,0 +1,72 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+// Material and piece-square tables, from white's side with A8 first.
+// Written by the tuner (test/tune.cpp), edit with care.
+
+#pragma once
+
+namespace FoChess {
+
+inline constexpr int piece_values[5] = {180, 550, 630, 900, 1340};
+
+inline constexpr int pawn_table[64] = {
+    990,  990,  990,  990,  990,  990,  990,  990,
+      5,   10,   10,   20,   20,   10,   10,    5,
+      5,    5,   10,    0,    0,   10,    5,    5,
+      0,    0,    0,   20,   20,    0,    0,    0,
+      5,    5,   10,   25,   25,   10,    5,    5,
+     10,   20,   20,   20,   20,   20,   20,   10,
+     30,   30,   20,   20,   20,   20,   30,   30,
+      0,    0,    0,    0,    0,    0,    0,    0,
+};
+
+inline constexpr int knight_table[64] = {
+    -50,  -40,  -30,  -30,  -30,  -30,  -40,  -50,
+    -40,  -20,    0,    0,    0,    0,  -20,  -40,
+    -30,    0,   10,   15,   15,   10,    0,  -30,
+    -30,    5,   15,   20,   20,   15,    5,  -30,
+    -30,    0,   15,   20,   20,   15,    0,  -30,
+    -30,    5,   10,   15,   15,   10,    5,  -30,
+    -40,  -20,    0,    5,    5,    0,  -20,  -40,
+    -50,  -40,  -30,  -30,  -30,  -30,  -40,  -50,
+};
+
+inline constexpr int bishop_table[64] = {
+    -20,  -10,  -10,  -10,  -10,  -10,  -10,  -20,
+    -10,    0,    0,    0,    0,    0,    0,  -10,
+    -10,    0,    5,   10,   10,    5,    0,  -10,
+    -10,    5,    5,   10,   10,    5,    5,  -10,
+    -10,    0,   10,   10,   10,   10,    0,  -10,
+    -10,   10,   10,   10,   10,   10,   10,  -10,
+    -10,    9,    0,    0,    0,    0,    9,  -10,
+    -20,  -10,  -10,  -10,  -10,  -10,  -10,  -20,
+};
+
+inline constexpr int rook_table[64] = {
+      0,    1,    1,    1,    1,    1,    1,    0,
+      5,   10,   10,   10,   10,   10,   10,    5,
+     -5,    0,    0,    0,    0,    0,    0,   -5,
+     -5,    0,    0,    0,    0,    0,    0,   -5,
+     -5,    0,    0,    0,    0,    0,    0,   -5,
+     -5,    0,    0,    0,    0,    0,    0,   -5,
+      0,   10,   10,   10,   10,   10,   10,    0,
+      0,    0,    0,    5,    5,    0,    0,    0,
+};
+
+inline constexpr int queen_table[64] = {
+    -20,  -10,  -10,   -5,   -5,  -10,  -10,  -20,
+    -10,    1,    2,    1,    1,    2,    1,  -10,
+    -10,    0,    2,    2,    2,    2,    1,  -10,
+     -5,    0,    3,    4,    4,    3,    1,   -5,
+      0,    0,    3,    5,    5,    3,    1,   -5,
+    -10,    5,    5,    5,    5,    5,    1,  -10,
+    -10,    0,    5,    0,    0,    0,    0,  -10,
+    -20,  -10,  -10,   -5,   -5,  -10,  -10,  -20,
+};
+
+}  // namespace FoChess
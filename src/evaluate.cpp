@@ -6,89 +6,59 @@
 // -----------------------------------------------------------------------------
 
 #include <cstddef>
+#include "bitbase.h"
 #include "board.h"
+#include "eval_tables.h"
 #include "types.h"
   
 namespace FoChess {
 
-static constexpr int piece_values[5] = {180, 550, 630, 900, 1340};
-static constexpr int pawn_table[64] = {
-    990,  990,  990,  990,  990,  990,  990,  990,
-    5, 10, 10,20,20, 10, 10,  5,
-    5, 5,10,  0,  0,10, 5,  5,
-    0,  0,  0, 20, 20,  0,  0,  0,
-    5,  5, 10,25,25, 10,  5,  5,
-   10, 20, 20,20,20, 20, 20, 10,
-   30, 30, 20,20,20, 20, 30, 30,
-    0,  0,  0,  0,  0,  0,  0,  0
+constexpr const int* pst_tables[5] = {
+    pawn_table, knight_table, bishop_table, rook_table, queen_table
 };
 
-static constexpr int knight_table[64] = {
-   -50,-40,-30,-30,-30,-30,-40,-50,
-   -40,-20,  0,  0,  0,  0,-20,-40,
-   -30,  0, 10,15,15,10,  0,-30,
-   -30,  5, 15,20,20,15,  5,-30,
-   -30,  0, 15,20,20,15,  0,-30,
-   -30,  5, 10,15,15,10,  5,-30,
-   -40,-20,  0,  5,  5,  0,-20,-40,
-   -50,-40,-30,-30,-30,-30,-40,-50
-};
+// Clearly winning, but well below mate and tablebase scores
+static constexpr int KNOWN_WIN = 10000;
 
-static constexpr int bishop_table[64] = {
-   -20,-10,-10,-10,-10,-10,-10,-20,
-   -10,  0,  0,  0,  0,  0,  0,-10,
-   -10,  0,  5,10,10, 5,  0,-10,
-   -10,  5,  5,10,10, 5,  5,-10,
-   -10,  0, 10,10,10,10,  0,-10,
-   -10, 10, 10,10,10,10, 10,-10,
-   -10,  9,  0,  0,  0,  0,  9,-10,
-   -20,-10,-10,-10,-10,-10,-10,-20
-};
+// King and pawn versus king, exact from the bitbase. Wins still prefer a
+// more advanced pawn so the search keeps pushing it.
+static int evaluate_kpk(const Board& board) {
+  const Color strong = board.pieces(WHITE, PAWN) ? WHITE : BLACK;
+  const Color weak = Color(BLACK - strong);
+  // Bitbases work with white holding the pawn, flip the board otherwise
+  const int flip = strong == WHITE ? 0 : 56;
+  const Square psq = Square(std::countr_zero(board.pieces(strong, PAWN)) ^ flip);
+  const Square wksq = Square(board.kingSq[strong] ^ flip);
+  const Square bksq = Square(board.kingSq[weak] ^ flip);
+  const Color stm = board.sideToMove == strong ? WHITE : BLACK;
 
-static constexpr int rook_table[64] = {
-     0,  1,  1,  1,  1,  1,  1,  0,
-     5, 10, 10, 10, 10, 10, 10,  5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-     0, 10, 10, 10, 10, 10, 10,  0,
-     0,  0,  0,  5,  5,  0,  0,  0
-};
-
-static constexpr int queen_table[64] = {
-   -20,-10,-10, -5, -5,-10,-10,-20,
-   -10,  1,  2,  1,  1,  2,  1,-10,
-   -10,  0,  2,  2,  2,  2,  1,-10,
-    -5,  0,  3,  4,  4,  3,  1, -5,
-     0,  0,  3,  5,  5,  3,  1, -5,
-   -10,  5,  5,  5,  5,  5,  1,-10,
-   -10,  0,  5,  0,  0,  0,  0,-10,
-   -20,-10,-10, -5, -5,-10,-10,-20
-};
-
-constexpr const int* pst_tables[5] = {
-    pawn_table, knight_table, bishop_table, rook_table, queen_table
-};
+  if (!Bitbases::probe_kpk(wksq, psq, bksq, stm)) return 0;
+  const int score = KNOWN_WIN + piece_values[PAWN] + 10 * (7 - psq / 8);
+  return board.sideToMove == strong ? score : -score;
+}
 
 // -----------------------------------------------------------------------------
 //  Evaluation function
 // -----------------------------------------------------------------------------
 int bland_evaluate(const Board& board) {
+  if (std::popcount(board.allPieces()) == 3 &&
+      std::popcount(board.pieces(WHITE, PAWN) | board.pieces(BLACK, PAWN)) == 1)
+    return evaluate_kpk(board);
+
   int score = 0;
 
   for (size_t pt = 0; pt < 5; ++pt) {
     const int val = piece_values[pt];
     const int* pst = pst_tables[pt];
 
-    Bitboard bbW = board.pieces[WHITE][pt];
+    Bitboard bbW = board.pieces(WHITE, Piece(pt));
     while (bbW) {
       const int sq = std::countr_zero(bbW);
       bbW &= bbW - 1;
       score += val + pst[sq];
     }
 
-    Bitboard bbB = board.pieces[BLACK][pt];
+    Bitboard bbB = board.pieces(BLACK, Piece(pt));
     while (bbB) {
       const int sq = std::countr_zero(bbB);
       bbB &= bbB - 1;
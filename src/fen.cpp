@@ -7,8 +7,10 @@
 
 #include "fen.h"
 
+#include <algorithm>
+#include <bit>
+#include <charconv>
 #include <cstddef>
-#include <sstream>
 
 #include "board.h"
 #include "types.h"
@@ -16,157 +18,229 @@
 
 namespace {
 
+constexpr char PIECE_CHARS[2][7] = {"PNBRQK", "pnbrqk"};
+
 inline Piece charToPiece(char c) {
-  switch (std::toupper(c)) {
-    case 'P': return PAWN;
-    case 'N': return KNIGHT;
-    case 'B': return BISHOP;
-    case 'R': return ROOK;
-    case 'Q': return QUEEN;
-    case 'K': return KING;
+  switch (c) {
+    case 'P': case 'p': return PAWN;
+    case 'N': case 'n': return KNIGHT;
+    case 'B': case 'b': return BISHOP;
+    case 'R': case 'r': return ROOK;
+    case 'Q': case 'q': return QUEEN;
+    case 'K': case 'k': return KING;
     default: return NO_PIECE;
   }
 }
 
 inline Color charToColor(char c) {
-  return std::isupper(c) ? WHITE : BLACK;
+  return c >= 'a' ? BLACK : WHITE;
 }
 
-inline char pieceToChar(Piece pt, Color c) {
-  char ch = '?';
-  switch (pt) {
-    case PAWN: ch = 'P'; break;
-    case KNIGHT: ch = 'N'; break;
-    case BISHOP: ch = 'B'; break;
-    case ROOK: ch = 'R'; break;
-    case QUEEN: ch = 'Q'; break;
-    case KING: ch = 'K'; break;
-    default: ch = '?'; break;
-  }
-  if (c == BLACK) ch = static_cast<char>(std::tolower(ch));
-  return ch;
+inline bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
 }
 
+// Cursor over the input, fields are separated by any run of blanks
+struct Reader {
+  std::string_view s;
+  size_t i = 0;
+
+  bool done() const { return i >= s.size(); }
+  char peek() const { return done() ? '\0' : s[i]; }
+  bool at_field_end() const { return done() || is_space(s[i]); }
+
+  // Moves to the next field, false when there is none
+  bool next_field() {
+    while (!done() && is_space(s[i])) ++i;
+    return !done();
+  }
+
+  // Reads a decimal counter, false when the field is not a number
+  bool number(unsigned& value) {
+    value = 0;
+    const size_t start = i;
+    while (!done() && s[i] >= '0' && s[i] <= '9' && i - start < 9)
+      value = value * 10 + static_cast<unsigned>(s[i++] - '0');
+    return i > start && at_field_end();
+  }
+};
+
 }  // anonymous namespace
 
 namespace FEN {
 
-Board parse(const std::string& fen) {
-  Board board;
-
-  std::istringstream ss(fen);
-  std::string piecePart, sidePart, castlePart, epPart;
-  ss >> piecePart >> sidePart >> castlePart >> epPart;
+const char* error_str(Error error) {
+  switch (error) {
+    case Error::NONE: return "ok";
+    case Error::BAD_BOARD: return "bad piece placement";
+    case Error::BAD_SIDE: return "bad side to move";
+    case Error::BAD_CASTLING: return "bad castling rights";
+    case Error::BAD_EN_PASSANT: return "bad en passant square";
+    case Error::BAD_COUNTERS: return "bad move counters";
+    case Error::BAD_KINGS: return "not one king per side";
+    case Error::TRAILING_DATA: return "trailing data";
+  }
+  return "unknown";
+}
 
-  int sq = 0;
-  for (char c : piecePart) {
-    if (c == '/') continue;
-    if (std::isdigit(c)) {
-      sq += c - '0';
+Error parse(std::string_view fen, Board& board, uint16_t* fullmove) {
+  board = Board();
+  if (fullmove) *fullmove = 1;
+
+  Reader in{fen};
+  if (!in.next_field()) return Error::BAD_BOARD;
+
+  // Pieces, rank 8 first, which is also our square order
+  size_t row = 0, file = 0;
+  for (; !in.at_field_end(); ++in.i) {
+    const char c = fen[in.i];
+    if (c == '/') {
+      if (file != 8 || ++row > 7) return Error::BAD_BOARD;
+      file = 0;
+    } else if (c >= '1' && c <= '8') {
+      file += static_cast<size_t>(c - '0');
+      if (file > 8) return Error::BAD_BOARD;
     } else {
-      Piece pt = charToPiece(c);
-      Color col = charToColor(c);
-      board.pieces[col][pt] |= (1ULL << sq);
-      ++sq;
+      const Piece pt = charToPiece(c);
+      if (pt == NO_PIECE || file > 7) return Error::BAD_BOARD;
+      const Color col = charToColor(c);
+      const size_t sq = row * 8 + file++;
+      board.put_piece(col, pt, Square(sq));
+      board.hash ^= Zobrist::pieces_keys[Zobrist::piece_to_idx(col, pt, sq)];
     }
   }
+  if (row != 7 || file != 8) return Error::BAD_BOARD;
 
-  board.updateOccupancy();
+  if (!in.next_field()) return Error::BAD_SIDE;
+  const char side = in.s[in.i++];
+  if ((side != 'w' && side != 'b') || !in.at_field_end()) return Error::BAD_SIDE;
+  board.sideToMove = side == 'w' ? WHITE : BLACK;
+  if (board.sideToMove == BLACK) board.hash ^= Zobrist::sideToMove_key;
 
-  board.sideToMove = (sidePart == "w") ? WHITE : BLACK;
-
-  CastlingRights cr;
-  for (char c : castlePart) {
-    switch (c) {
-      case 'K': cr.whiteKingside = true; break;
-      case 'Q': cr.whiteQueenside = true; break;
-      case 'k': cr.blackKingside = true; break;
-      case 'q': cr.blackQueenside = true; break;
-      case '-': break;
-      default: break;
+  if (!in.next_field()) return Error::BAD_CASTLING;
+  if (in.peek() == '-') {
+    ++in.i;
+  } else {
+    for (; !in.at_field_end(); ++in.i) {
+      CastlingRight right = NO_CASTLING;
+      switch (fen[in.i]) {
+        case 'K': right = WHITE_KINGSIDE; break;
+        case 'Q': right = WHITE_QUEENSIDE; break;
+        case 'k': right = BLACK_KINGSIDE; break;
+        case 'q': right = BLACK_QUEENSIDE; break;
+        default: return Error::BAD_CASTLING;
+      }
+      if (board.can_castle(right)) return Error::BAD_CASTLING;
+      board.castling |= right;
     }
   }
-  board.castling = cr;
+  if (!in.at_field_end()) return Error::BAD_CASTLING;
+  board.hash ^= Zobrist::castling_keys[board.castling];
 
-  // En Passant processing
-  if (epPart == "-") {
-    board.enPassant = NO_SQUARE;
+  if (!in.next_field()) return Error::BAD_EN_PASSANT;
+  if (in.peek() == '-') {
+    ++in.i;
   } else {
-    char file = epPart[0];
-    char rank = epPart[1];
-    int f = file - 'a';
-    int r = '8' - rank;
-    board.enPassant = static_cast<Square>(r * 8 + f);
+    const char f = in.s[in.i++];
+    const char r = in.peek();
+    // Only a pawn of the side not to move that just went two squares
+    // leaves one, with its start and skipped squares empty
+    const bool white = board.sideToMove == WHITE;
+    if (f < 'a' || f > 'h' || r != (white ? '6' : '3')) return Error::BAD_EN_PASSANT;
+    ++in.i;
+    const int ep = ('8' - r) * 8 + (f - 'a');
+    const int pushed = white ? ep + 8 : ep - 8, start = white ? ep - 8 : ep + 8;
+    if (!(board.pieces(white ? BLACK : WHITE, PAWN) & Bitboards::square_bb(Square(pushed))) ||
+        (board.allPieces() & (Bitboards::square_bb(Square(ep)) | Bitboards::square_bb(Square(start)))))
+      return Error::BAD_EN_PASSANT;
+    board.enPassant = static_cast<Square>(ep);
+    board.hash ^= Zobrist::enPassant_keys[board.enPassant];
+  }
+  if (!in.at_field_end()) return Error::BAD_EN_PASSANT;
+
+  // Move counters are optional, but come as a pair
+  if (in.next_field()) {
+    unsigned halfmove = 0, moves = 0;
+    if (!in.number(halfmove) || !in.next_field() || !in.number(moves))
+      return Error::BAD_COUNTERS;
+    board.halfMoveClock = static_cast<uint8_t>(std::min(halfmove, 255u));
+    if (fullmove) *fullmove = static_cast<uint16_t>(std::clamp(moves, 1u, 65535u));
   }
 
-  board.hash = Zobrist::generate_hash(board);
+  if (std::popcount(board.pieces(WHITE, KING)) != 1 ||
+      std::popcount(board.pieces(BLACK, KING)) != 1)
+    return Error::BAD_KINGS;
+  board.update_checkers();
+  if (in.next_field()) return Error::TRAILING_DATA;
+  return Error::NONE;
+}
 
+Board parse(std::string_view fen) {
+  Board board;
+  // Fields past an error keep their defaults, the hash must still match
+  if (parse(fen, board) != Error::NONE) {
+    board.update_checkers();
+    board.hash = Zobrist::generate_hash(board);
+  }
   return board;
 }
 
-std::string to_fen(const Board& board) {
-  std::string fen;
+void append(const Board& board, std::string& out, uint16_t fullmove) {
+  char squares[64] = {};
+  for (size_t c = 0; c < 2; ++c)
+    for (size_t p = 0; p < 6; ++p) {
+      Bitboard bb = board.pieces(Color(c), Piece(p));
+      while (bb) squares[Bitboards::pop_lsb(bb)] = PIECE_CHARS[c][p];
+    }
 
-  for (int rank = 7; rank >= 0; --rank) {
-    int empty = 0;
-    for (int file = 0; file < 8; ++file) {
-      int sq = (7 - rank) * 8 + file; 
-      Bitboard mask = 1ULL << sq;
-      bool found = false;
-      for (size_t c = 0; c < 2; ++c) {
-        for (size_t p = 0; p < 6; ++p) {
-          if (board.pieces[c][p] & mask) {
-            if (empty > 0) {
-              fen += std::to_string(empty);
-              empty = 0;
-            }
-            fen += ::pieceToChar(static_cast<Piece>(p), static_cast<Color>(c));
-            found = true;
-            break;
-          }
-        }
-        if (found) break;
+  for (size_t row = 0; row < 8; ++row) {
+    char empty = '0';
+    for (size_t file = 0; file < 8; ++file) {
+      const char piece = squares[row * 8 + file];
+      if (!piece) {
+        ++empty;
+        continue;
       }
-      if (!found) ++empty;
+      if (empty != '0') out += empty;
+      empty = '0';
+      out += piece;
     }
-    if (empty > 0) fen += std::to_string(empty);
-    if (rank > 0) fen += '/';
+    if (empty != '0') out += empty;
+    if (row < 7) out += '/';
   }
 
-  fen += ' ';
-  fen += (board.sideToMove == WHITE) ? 'w' : 'b';
+  out += ' ';
+  out += board.sideToMove == WHITE ? 'w' : 'b';
 
-  fen += ' ';
-  bool any = false;
-  if (board.castling.whiteKingside) {
-    fen += 'K';
-    any = true;
-  }
-  if (board.castling.whiteQueenside) {
-    fen += 'Q';
-    any = true;
-  }
-  if (board.castling.blackKingside) {
-    fen += 'k';
-    any = true;
-  }
-  if (board.castling.blackQueenside) {
-    fen += 'q';
-    any = true;
+  out += ' ';
+  if (board.can_castle(WHITE_KINGSIDE)) out += 'K';
+  if (board.can_castle(WHITE_QUEENSIDE)) out += 'Q';
+  if (board.can_castle(BLACK_KINGSIDE)) out += 'k';
+  if (board.can_castle(BLACK_QUEENSIDE)) out += 'q';
+  if (board.castling == NO_CASTLING) out += '-';
+
+  out += ' ';
+  if (board.enPassant == NO_SQUARE) {
+    out += '-';
+  } else {
+    out += static_cast<char>('a' + board.enPassant % 8);
+    out += static_cast<char>('8' - board.enPassant / 8);
   }
-  if (!any) fen += '-';
-
-  // En Croissant processing
-  fen += ' ';
-  if (board.enPassant == NO_SQUARE)
-    fen += '-';
-  else {
-    int r = board.enPassant / 8;
-    int f = board.enPassant % 8;
-    fen += static_cast<char>('a' + f);
-    fen += static_cast<char>('8' - r);
+
+  if (fullmove) {
+    char buf[16];
+    buf[0] = ' ';
+    char* end = std::to_chars(buf + 1, buf + sizeof(buf), board.halfMoveClock).ptr;
+    *end++ = ' ';
+    end = std::to_chars(end, buf + sizeof(buf), fullmove).ptr;
+    out.append(buf, end);
   }
+}
 
+std::string to_fen(const Board& board) {
+  std::string fen;
+  fen.reserve(96);
+  append(board, fen);
   return fen;
 }
 
@@ -7,13 +7,40 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 #include "board.h"
 
 namespace FEN {
 
-Board parse(const std::string& fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -");
+enum class Error : uint8_t {
+  NONE,
+  BAD_BOARD,       // not 8 ranks of 8 squares, or an unknown piece
+  BAD_SIDE,
+  BAD_CASTLING,
+  BAD_EN_PASSANT,  // not "-" or a square a pawn just skipped
+  BAD_COUNTERS,
+  BAD_KINGS,       // not exactly one king per side
+  TRAILING_DATA,   // anything after the move counters
+};
+
+const char* error_str(Error error);
+
+// Single pass over fen straight into board, hash included, without
+// allocating. The move counters are optional; the board has no full move
+// number, it goes to fullmove when given (1 without counters). On error
+// board holds what was read up to that point.
+Error parse(std::string_view fen, Board& board, uint16_t* fullmove = nullptr);
+
+// Lenient version: whatever could be read, for input known to be good
+Board parse(std::string_view fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -");
+
+// Appends the four FEN fields to out, and the move counters when given a
+// full move number
+void append(const Board& board, std::string& out, uint16_t fullmove = 0);
+
 std::string to_fen(const Board& board);
 
 }  // namespace FEN
@@ -5,10 +5,12 @@
 //  Read the LICENSE file in the project root please.
 // -----------------------------------------------------------------------------
 
+#include <array>
 #include <cctype>
 #include <iostream>
 
 #include "board.h"
+#include "movegen.h"
 #include "types.h"
 
 #pragma once
@@ -41,7 +43,7 @@ inline void printBoard(Board board) {
 
       for (size_t c = 0; c < 2 && symbol == '.'; ++c) {
         for (size_t p = 0; p < 6 && symbol == '.'; ++p) {
-          if (board.pieces[c][p] & mask) {
+          if (board.pieces(Color(c), Piece(p)) & mask) {
             symbol = pieceChar(static_cast<Piece>(p), static_cast<Color>(c));
           }
         }
@@ -138,13 +140,74 @@ inline Move uci_to_move(const std::string& s, const Board& board) {
   return Move(from_sq, to_sq);
 }
 
-constexpr uint64_t encode_castling(const CastlingRights& cr) {
-    uint64_t code = 0;
-    if (cr.whiteKingside)  code |= 1 << 0;
-    if (cr.whiteQueenside) code |= 1 << 1;
-    if (cr.blackKingside)  code |= 1 << 2;
-    if (cr.blackQueenside) code |= 1 << 3;
-    return code;
+// Standard algebraic notation for a legal move: "Nbd7", "exd6", "e8=Q+"
+inline std::string move_to_san(const Move& m, const Board& board) {
+  const Square from = m.from_sq(), to = m.to_sq();
+  const Piece pt = board.piece_on(from);
+  std::string s;
+
+  if (m.type() == CASTLING) {
+    s = to > from ? "O-O" : "O-O-O";
+  } else {
+    const bool capture = board.piece_on(to) != NO_PIECE || m.type() == EN_PASSANT;
+    std::array<Move, MAX_MOVES> moves;
+    const size_t n = MoveGen::generate_all(board, moves);
+
+    if (pt == PAWN) {
+      if (capture) s += static_cast<char>('a' + from % 8);
+    } else {
+      s += pieceChar(pt, WHITE);
+
+      // Another piece of the same kind that can go there too
+      bool ambiguous = false, same_file = false, same_rank = false;
+      for (size_t i = 0; i < n; ++i) {
+        const Square other = moves[i].from_sq();
+        if (other == from || moves[i].to_sq() != to || board.piece_on(other) != pt)
+          continue;
+        ambiguous = true;
+        same_file |= other % 8 == from % 8;
+        same_rank |= other / 8 == from / 8;
+      }
+      if (ambiguous) {
+        if (!same_file) s += static_cast<char>('a' + from % 8);
+        else if (!same_rank) s += static_cast<char>('8' - from / 8);
+        else s += square_to_str(from);
+      }
+    }
+
+    if (capture) s += 'x';
+    s += square_to_str(to);
+    if (m.type() == PROMOTION) {
+      s += '=';
+      s += pieceChar(m.promotion_type(), WHITE);
+    }
+  }
+
+  Board next = board;
+  next.makeMove(m);
+  if (next.is_in_check(next.sideToMove)) {
+    std::array<Move, MAX_MOVES> replies;
+    s += MoveGen::generate_all(next, replies) ? '+' : '#';
+  }
+  return s;
+}
+
+// Legal move written in SAN, annotations ("+", "!?") and a "0-0" style
+// castling are accepted. EMPTY_MOVE when nothing matches.
+inline Move san_to_move(std::string san, const Board& board) {
+  while (!san.empty() && std::string("+#!?").find(san.back()) != std::string::npos)
+    san.pop_back();
+  for (char& c : san)
+    if (c == '0') c = 'O';
+
+  std::array<Move, MAX_MOVES> moves;
+  const size_t n = MoveGen::generate_all(board, moves);
+  for (size_t i = 0; i < n; ++i) {
+    std::string candidate = move_to_san(moves[i], board);
+    while (candidate.back() == '+' || candidate.back() == '#') candidate.pop_back();
+    if (candidate == san) return moves[i];
+  }
+  return Move();
 }
 
 }  // namespace PrintingHelpers
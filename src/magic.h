@@ -241,6 +241,7 @@ constexpr std::array<SMagic, 64> bishop_magics = {
 
 inline std::array<std::array<Bitboard, 4096>, 64> rook_attack_table;
 inline std::array<std::array<Bitboard, 512>, 64> bishop_attack_table;
+inline std::array<std::array<Bitboard, 64>, 64> between_table;
 
 inline void init_magic_tables() {
   for (size_t sq = 0; sq < 64; ++sq) {
@@ -267,6 +268,20 @@ inline void init_magic_tables() {
       bishop_attack_table[sq][idx] = attacks;
     }
   }
+
+  // Each ray stops at the other square, so the two overlap exactly on the
+  // squares in between (rays across the line are parallel)
+  for (size_t a = 0; a < 64; ++a) {
+    for (size_t b = 0; b < 64; ++b) {
+      const Bitboard a_bb = 1ULL << a, b_bb = 1ULL << b;
+      if (generate_rook_attacks(Square(a), 0) & b_bb)
+        between_table[a][b] = generate_rook_attacks(Square(a), b_bb) &
+                              generate_rook_attacks(Square(b), a_bb);
+      else if (generate_bishop_attacks(Square(a), 0) & b_bb)
+        between_table[a][b] = generate_bishop_attacks(Square(a), b_bb) &
+                              generate_bishop_attacks(Square(b), a_bb);
+    }
+  }
 }
 
 // ------------------------------------------------------------
@@ -288,6 +303,11 @@ constexpr Bitboard queen_attacks(Square sq, Bitboard occ) {
   return rook_attacks(sq, occ) | bishop_attacks(sq, occ);
 }
 
+// Squares strictly between a and b when they share a line, 0 otherwise
+inline Bitboard between(Square a, Square b) {
+  return between_table[a][b];
+}
+
 constexpr Bitboard rook_moves(Square sq, Bitboard occ, Bitboard friendly) {
   return rook_attacks(sq, occ) & ~friendly;
 }
@@ -0,0 +1,483 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "match.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <sstream>
+
+#include "fen.h"
+#include "helpers.h"
+#include "movegen.h"
+
+#ifdef __linux__
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace Match {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int64_t HANDSHAKE_MS = 10000;
+// Allowed clock overshoot, covers the pipe and scheduling latency
+constexpr int64_t TIME_MARGIN_MS = 100;
+// Depth and node limited searches have no clock, this catches hangs
+constexpr int64_t HANG_MS = 60000;
+constexpr int MATE_CP = 100000;
+
+constexpr const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -";
+
+int64_t elapsed_ms(Clock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - since)
+      .count();
+}
+
+// Score from an info line, in centipawns for the side to move
+bool parse_score(const std::string& line, int& score) {
+  std::istringstream ss(line);
+  std::string token;
+  while (ss >> token) {
+    if (token != "score") continue;
+    int value = 0;
+    ss >> token >> value;
+    if (token == "cp") {
+      score = value;
+      return true;
+    }
+    if (token == "mate") {
+      score = value > 0 ? MATE_CP - value : -MATE_CP - value;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool insufficient_material(const Board& board) {
+  if (board.byType[PAWN] | board.byType[ROOK] | board.byType[QUEEN]) return false;
+
+  const Bitboard knights = board.byType[KNIGHT];
+  const Bitboard bishops = board.byType[BISHOP];
+  if (std::popcount(knights | bishops) <= 1) return true;
+
+  // Any number of bishops, all on one colour
+  constexpr Bitboard DARK = 0x55AA55AA55AA55AAULL;
+  return !knights && (!(bishops & DARK) || !(bishops & ~DARK));
+}
+
+// Placement, side to move, castling and en passant, without the counters
+std::string position_fields(const std::string& fen) {
+  std::istringstream ss(fen);
+  std::string field, fields;
+  for (int i = 0; i < 4 && ss >> field; ++i) fields += (i ? " " : "") + field;
+  return fields;
+}
+
+// Fullmove number of a FEN, 1 when it has none
+int fullmove_of(const std::string& fen) {
+  std::istringstream ss(fen);
+  std::string field;
+  int n = 1;
+  for (int i = 0; i < 6 && ss >> field; ++i)
+    if (i == 5) n = std::max(1, std::atoi(field.c_str()));
+  return n;
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+//  Engine process
+// -----------------------------------------------------------------------------
+#ifdef __linux__
+
+bool EngineProcess::start(const std::string& path) {
+  stop();
+
+  // A dead engine must not take us down on the next write
+  std::signal(SIGPIPE, SIG_IGN);
+
+  int in_pipe[2], out_pipe[2];
+  if (pipe2(in_pipe, O_CLOEXEC) != 0) return false;
+  if (pipe2(out_pipe, O_CLOEXEC) != 0) {
+    close(in_pipe[0]);
+    close(in_pipe[1]);
+    return false;
+  }
+
+  pid = fork();
+  if (pid == 0) {
+    dup2(in_pipe[0], STDIN_FILENO);
+    dup2(out_pipe[1], STDOUT_FILENO);
+    execl(path.c_str(), path.c_str(), static_cast<char*>(nullptr));
+    _exit(127);
+  }
+
+  close(in_pipe[0]);
+  close(out_pipe[1]);
+  to_engine = in_pipe[1];
+  from_engine = out_pipe[0];
+  if (pid < 0) {
+    stop();
+    return false;
+  }
+
+  send("uci");
+  std::string line;
+  while (read_line(line, HANDSHAKE_MS)) {
+    if (line.rfind("id name ", 0) == 0) id_name = line.substr(8);
+    if (line == "uciok") return sync();
+  }
+  stop();
+  return false;
+}
+
+void EngineProcess::stop() {
+  if (to_engine >= 0) {
+    send("quit");
+    close(to_engine);
+  }
+  if (from_engine >= 0) close(from_engine);
+  to_engine = from_engine = -1;
+  buffer.clear();
+
+  if (pid > 0) {
+    // Give it a moment to exit on quit before killing it
+    for (int i = 0; i < 20 && waitpid(pid, nullptr, WNOHANG) == 0; ++i) usleep(10000);
+    if (waitpid(pid, nullptr, WNOHANG) == 0) {
+      kill(pid, SIGKILL);
+      waitpid(pid, nullptr, 0);
+    }
+  }
+  pid = -1;
+}
+
+void EngineProcess::send(const std::string& line) {
+  if (to_engine < 0) return;
+  const std::string data = line + '\n';
+  size_t done = 0;
+  while (done < data.size()) {
+    const ssize_t n = write(to_engine, data.data() + done, data.size() - done);
+    if (n <= 0) return;
+    done += static_cast<size_t>(n);
+  }
+}
+
+bool EngineProcess::read_line(std::string& line, int64_t timeout_ms) {
+  const auto start = Clock::now();
+  while (true) {
+    const size_t eol = buffer.find('\n');
+    if (eol != std::string::npos) {
+      line = buffer.substr(0, eol);
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      buffer.erase(0, eol + 1);
+      return true;
+    }
+
+    const int64_t left = timeout_ms - elapsed_ms(start);
+    if (from_engine < 0 || left <= 0) return false;
+
+    pollfd pfd{from_engine, POLLIN, 0};
+    if (poll(&pfd, 1, static_cast<int>(left)) <= 0) return false;
+
+    char chunk[4096];
+    const ssize_t n = read(from_engine, chunk, sizeof(chunk));
+    if (n <= 0) return false;
+    buffer.append(chunk, static_cast<size_t>(n));
+  }
+}
+
+#else
+
+bool EngineProcess::start(const std::string&) { return false; }
+void EngineProcess::stop() {}
+void EngineProcess::send(const std::string&) {}
+bool EngineProcess::read_line(std::string&, int64_t) { return false; }
+
+#endif
+
+bool EngineProcess::sync(int64_t timeout_ms) {
+  send("isready");
+  std::string line;
+  while (read_line(line, timeout_ms))
+    if (line == "readyok") return true;
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+//  Games
+// -----------------------------------------------------------------------------
+GameResult adjudicate(const Board& board, const std::vector<uint64_t>& history,
+                      std::string& reason) {
+  std::array<Move, MAX_MOVES> moves;
+  if (MoveGen::generate_all(board, moves) == 0) {
+    if (!board.is_in_check(board.sideToMove)) {
+      reason = "stalemate";
+      return DRAWN;
+    }
+    reason = board.sideToMove == WHITE ? "black mates" : "white mates";
+    return board.sideToMove == WHITE ? BLACK_WINS : WHITE_WINS;
+  }
+
+  if (board.halfMoveClock >= 100) {
+    reason = "fifty move rule";
+    return DRAWN;
+  }
+  if (std::count(history.begin(), history.end(), board.hash) >= 2) {
+    reason = "threefold repetition";
+    return DRAWN;
+  }
+  if (insufficient_material(board)) {
+    reason = "insufficient material";
+    return DRAWN;
+  }
+  return ONGOING;
+}
+
+Game play_game(EngineProcess& white, EngineProcess& black, const std::string& fen,
+               const Limits& limits, const Adjudication& adj) {
+  Game game;
+  game.white = white.name();
+  game.black = black.name();
+  game.start_fen = fen;
+
+  std::array<EngineProcess*, 2> engines = {&white, &black};
+  std::array<int64_t, 2> clock = {limits.base_ms, limits.base_ms};
+
+  auto forfeit = [&](Color loser, const std::string& why) {
+    game.result = loser == WHITE ? BLACK_WINS : WHITE_WINS;
+    game.reason = (loser == WHITE ? "white " : "black ") + why;
+    return game;
+  };
+
+  for (Color c : {WHITE, BLACK}) {
+    engines[c]->send("ucinewgame");
+    if (!engines[c]->sync()) {
+      engines[c]->stop();
+      return forfeit(c, "not responding");
+    }
+  }
+
+  Board board = FEN::parse(fen);
+  std::vector<uint64_t> history;
+  std::string position = "position fen " + fen + " moves";
+  int last_score = 0, resign_count = 0, draw_count = 0;
+
+  while ((game.result = adjudicate(board, history, game.reason)) == ONGOING) {
+    const Color us = board.sideToMove;
+    EngineProcess& engine = *engines[us];
+
+    std::string go = "go";
+    int64_t timeout = HANG_MS;
+    if (limits.base_ms > 0) {
+      go += " wtime " + std::to_string(clock[WHITE]) + " btime " + std::to_string(clock[BLACK]);
+      go += " winc " + std::to_string(limits.inc_ms) + " binc " + std::to_string(limits.inc_ms);
+      timeout = clock[us] + TIME_MARGIN_MS;
+    } else if (limits.movetime_ms > 0) {
+      go += " movetime " + std::to_string(limits.movetime_ms);
+      timeout = 2 * limits.movetime_ms + 1000;
+    } else if (limits.depth > 0) {
+      go += " depth " + std::to_string(limits.depth);
+    } else if (limits.nodes > 0) {
+      go += " nodes " + std::to_string(limits.nodes);
+    }
+
+    engine.send(position);
+    engine.send(go);
+
+    const auto start = Clock::now();
+    std::string line, best;
+    int score = 0;
+    while (engine.read_line(line, timeout - elapsed_ms(start))) {
+      if (line.rfind("info", 0) == 0) {
+        parse_score(line, score);
+      } else if (line.rfind("bestmove", 0) == 0) {
+        std::istringstream ss(line);
+        ss >> best >> best;
+        break;
+      }
+    }
+
+    if (best.empty()) {
+      engine.stop();
+      return forfeit(us, "sent no move");
+    }
+
+    if (limits.base_ms > 0) {
+      clock[us] -= elapsed_ms(start);
+      if (clock[us] < -TIME_MARGIN_MS) return forfeit(us, "lost on time");
+      clock[us] = std::max<int64_t>(clock[us], 0) + limits.inc_ms;
+    }
+
+    std::array<Move, MAX_MOVES> moves;
+    const size_t n = MoveGen::generate_all(board, moves);
+    const auto it = std::find_if(moves.begin(), moves.begin() + static_cast<long>(n),
+                                 [&](const Move& m) {
+                                   return PrintingHelpers::move_to_str(m) == best;
+                                 });
+    if (it == moves.begin() + static_cast<long>(n)) return forfeit(us, "illegal move " + best);
+
+    game.san.push_back(PrintingHelpers::move_to_san(*it, board));
+    history.push_back(board.hash);
+    board.makeMove(*it);
+    position += " " + best;
+
+    // Both engines have to agree, so the score must hold over consecutive
+    // plies, which alternate between them
+    const int white_score = us == WHITE ? score : -score;
+    if (adj.resign_cp > 0 && std::abs(white_score) >= adj.resign_cp &&
+        (resign_count == 0 || (white_score > 0) == (last_score > 0)))
+      ++resign_count;
+    else
+      resign_count = 0;
+    draw_count = std::abs(white_score) <= adj.draw_cp ? draw_count + 1 : 0;
+    last_score = white_score;
+
+    if (resign_count >= adj.resign_plies) {
+      game.result = white_score > 0 ? WHITE_WINS : BLACK_WINS;
+      game.reason = "adjudicated on score";
+      break;
+    }
+    if (adj.draw_cp > 0 && static_cast<int>(game.san.size()) >= adj.draw_after &&
+        draw_count >= adj.draw_plies) {
+      game.result = DRAWN;
+      game.reason = "adjudicated draw";
+      break;
+    }
+  }
+  return game;
+}
+
+const char* result_str(GameResult result) {
+  switch (result) {
+    case WHITE_WINS: return "1-0";
+    case BLACK_WINS: return "0-1";
+    case DRAWN: return "1/2-1/2";
+    default: return "*";
+  }
+}
+
+std::string to_pgn(const Game& game) {
+  char date[16] = "????.??.??";
+  const std::time_t now = std::time(nullptr);
+  std::tm tm{};
+  if (localtime_r(&now, &tm)) std::strftime(date, sizeof(date), "%Y.%m.%d", &tm);
+
+  std::string pgn;
+  auto tag = [&](const char* name, const std::string& value) {
+    pgn += std::string("[") + name + " \"" + value + "\"]\n";
+  };
+  tag("Event", "FoChess match");
+  tag("Site", "?");
+  tag("Date", date);
+  tag("Round", std::to_string(game.round));
+  tag("White", game.white);
+  tag("Black", game.black);
+  tag("Result", result_str(game.result));
+
+  const Board start = FEN::parse(game.start_fen);
+  if (position_fields(game.start_fen) != position_fields(START_FEN)) {
+    tag("FEN", game.start_fen);
+    tag("SetUp", "1");
+  }
+  pgn += '\n';
+
+  // Movetext wrapped at 80 columns
+  std::string text;
+  size_t column = 0;
+  auto word = [&](const std::string& w) {
+    if (column > 0 && column + 1 + w.size() > 80) {
+      text += '\n';
+      column = 0;
+    } else if (column > 0) {
+      text += ' ';
+      ++column;
+    }
+    text += w;
+    column += w.size();
+  };
+
+  int number = fullmove_of(game.start_fen);
+  bool white_moves = start.sideToMove == WHITE;
+  for (size_t i = 0; i < game.san.size(); ++i) {
+    if (white_moves) word(std::to_string(number) + ".");
+    else if (i == 0) word(std::to_string(number) + "...");
+    word(game.san[i]);
+    if (!white_moves) ++number;
+    white_moves = !white_moves;
+  }
+  if (!game.reason.empty()) word("{" + game.reason + "}");
+  word(result_str(game.result));
+
+  return pgn + text + "\n\n";
+}
+
+// -----------------------------------------------------------------------------
+//  Statistics
+// -----------------------------------------------------------------------------
+namespace {
+
+struct Score {
+  double n, mean, variance;
+};
+
+Score score_of(uint64_t wins, uint64_t draws, uint64_t losses) {
+  const double w = static_cast<double>(wins), d = static_cast<double>(draws),
+               l = static_cast<double>(losses);
+  const double n = w + d + l;
+  if (n == 0) return {0, 0.5, 0};
+  const double mean = (w + 0.5 * d) / n;
+  const double variance = (w * (1 - mean) * (1 - mean) + d * (0.5 - mean) * (0.5 - mean) +
+                           l * mean * mean) /
+                          n;
+  return {n, mean, variance};
+}
+
+double elo_of(double score) {
+  if (score == 0.5) return 0;
+  score = std::clamp(score, 1e-6, 1 - 1e-6);
+  return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+double score_of_elo(double elo_diff) {
+  return 1.0 / (1.0 + std::pow(10.0, -elo_diff / 400.0));
+}
+
+}  // namespace
+
+double elo(uint64_t wins, uint64_t draws, uint64_t losses) {
+  return elo_of(score_of(wins, draws, losses).mean);
+}
+
+double elo_error(uint64_t wins, uint64_t draws, uint64_t losses) {
+  const Score s = score_of(wins, draws, losses);
+  if (s.n == 0) return 0;
+  const double margin = 1.959964 * std::sqrt(s.variance / s.n);
+  return (elo_of(s.mean + margin) - elo_of(s.mean - margin)) / 2;
+}
+
+double sprt_llr(uint64_t wins, uint64_t draws, uint64_t losses, double elo0, double elo1) {
+  const Score s = score_of(wins, draws, losses);
+  if (s.n == 0 || s.variance <= 0) return 0;
+  const double s0 = score_of_elo(elo0), s1 = score_of_elo(elo1);
+  return s.n * (s1 - s0) * (2 * s.mean - s0 - s1) / (2 * s.variance);
+}
+
+std::pair<double, double> sprt_bounds(double alpha, double beta) {
+  return {std::log(beta / (1 - alpha)), std::log((1 - beta) / alpha)};
+}
+
+}  // namespace Match
@@ -0,0 +1,111 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "board.h"
+
+/**
+ * Engine-vs-engine games over UCI, for strength checks between two builds.
+ * Engines run as child processes talking through pipes; this side keeps
+ * the real board, so illegal moves, time forfeits, mates and the draw
+ * rules are judged here and not trusted to the engines.
+ */
+namespace Match {
+
+enum GameResult : uint8_t { WHITE_WINS, BLACK_WINS, DRAWN, ONGOING };
+
+// Search limit per move. A base time means a real clock (base+inc),
+// otherwise the first nonzero of movetime, depth and nodes is sent.
+struct Limits {
+  int64_t base_ms = 0;
+  int64_t inc_ms = 0;
+  int64_t movetime_ms = 0;
+  int depth = 0;
+  uint64_t nodes = 0;
+};
+
+// Score based adjudication, a zero score turns the rule off. Resign when
+// both engines agree on a score of at least resign_cp for resign_plies
+// plies, draw once both stay within draw_cp for draw_plies plies after
+// draw_after plies.
+struct Adjudication {
+  int resign_cp = 1000;
+  int resign_plies = 6;
+  int draw_cp = 10;
+  int draw_plies = 16;
+  int draw_after = 80;
+};
+
+struct Game {
+  std::string white, black;
+  std::string start_fen;
+  std::vector<std::string> san;
+  GameResult result = ONGOING;
+  std::string reason;
+  int round = 0;
+};
+
+class EngineProcess {
+ public:
+  EngineProcess() = default;
+  ~EngineProcess() { stop(); }
+
+  EngineProcess(const EngineProcess&) = delete;
+  EngineProcess& operator=(const EngineProcess&) = delete;
+
+  // Spawns the binary and waits for uciok, false if it never answers
+  bool start(const std::string& path);
+  void stop();
+  bool running() const { return pid > 0; }
+
+  void send(const std::string& line);
+  // Next line, false on timeout or when the engine went away
+  bool read_line(std::string& line, int64_t timeout_ms);
+  // Sends isready and waits for readyok
+  bool sync(int64_t timeout_ms = 10000);
+
+  const std::string& name() const { return id_name; }
+
+ private:
+  pid_t pid = -1;
+  int to_engine = -1;
+  int from_engine = -1;
+  std::string buffer;
+  std::string id_name;
+};
+
+// Rules only: mate, stalemate, fifty moves, threefold repetition and
+// insufficient material. history holds the hashes of the earlier positions.
+GameResult adjudicate(const Board& board, const std::vector<uint64_t>& history,
+                      std::string& reason);
+
+// Plays one game from fen. Engines that crash, hang past their clock or
+// send an illegal move lose; they are stopped and need a restart then.
+Game play_game(EngineProcess& white, EngineProcess& black, const std::string& fen,
+               const Limits& limits, const Adjudication& adj);
+
+std::string to_pgn(const Game& game);
+const char* result_str(GameResult result);
+
+// Elo difference from a score, with the 95% error margin
+double elo(uint64_t wins, uint64_t draws, uint64_t losses);
+double elo_error(uint64_t wins, uint64_t draws, uint64_t losses);
+
+// Log-likelihood ratio of elo1 against elo0 (normal approximation of the
+// trinomial model) and the bounds for the given error rates
+double sprt_llr(uint64_t wins, uint64_t draws, uint64_t losses, double elo0, double elo1);
+std::pair<double, double> sprt_bounds(double alpha, double beta);
+
+}  // namespace Match
@@ -28,7 +28,7 @@ Move* add_promotions(Square from, Square to, Move* move_list) {
 
 Move* generate_pawn_captures(const Board& board, Move* move_list) {
   const Color us = board.sideToMove;
-  const Bitboard our_pawns = board.pieces[us][PAWN];
+  const Bitboard our_pawns = board.pieces(us, PAWN);
   const Bitboard their_pieces = board.occupancy[BLACK - us];
   const int promotion_rank = (us == WHITE) ? 7 : 0;
 
@@ -61,15 +61,15 @@ Move* generate_pawn_captures(const Board& board, Move* move_list) {
 Move* generate_piece_captures(const Board& board, Move* move_list, Piece pt) {
   const Color us = board.sideToMove;
   const Bitboard their_pieces = board.occupancy[BLACK - us];
-  Bitboard pieces = board.pieces[us][pt];
+  Bitboard pieces = board.pieces(us, pt);
   while (pieces) {
     const Square from = Bitboards::pop_lsb(pieces);
     Bitboard attacks = 0;
     switch (pt) {
       case KNIGHT: attacks = Bitboards::knight_attacks(from); break;
-      case BISHOP: attacks = Bitboards::bishop_attacks(from, board.allPieces); break;
-      case ROOK: attacks = Bitboards::rook_attacks(from, board.allPieces); break;
-      case QUEEN: attacks = Bitboards::queen_attacks(from, board.allPieces); break;
+      case BISHOP: attacks = Bitboards::bishop_attacks(from, board.allPieces()); break;
+      case ROOK: attacks = Bitboards::rook_attacks(from, board.allPieces()); break;
+      case QUEEN: attacks = Bitboards::queen_attacks(from, board.allPieces()); break;
       case KING: attacks = Bitboards::king_attacks(from); break;
       default: break;
     }
@@ -86,8 +86,8 @@ Move* generate_piece_captures(const Board& board, Move* move_list, Piece pt) {
 
 Move* generate_pawn_quiet_moves(const Board& board, Move* move_list) {
   const Color us = board.sideToMove;
-  const Bitboard our_pawns = board.pieces[us][PAWN];
-  const Bitboard empty = ~board.allPieces;
+  const Bitboard our_pawns = board.pieces(us, PAWN);
+  const Bitboard empty = ~board.allPieces();
   const int promotion_rank = (us == WHITE) ? 7 : 0;
 
   Bitboard pawns = our_pawns;
@@ -109,17 +109,17 @@ Move* generate_pawn_quiet_moves(const Board& board, Move* move_list) {
 Move* generate_piece_quiet_moves(const Board& board, Move* move_list,
                                  Piece pt) {
   const Color us = board.sideToMove;
-  const Bitboard empty = ~board.allPieces;
-  Bitboard pieces = board.pieces[us][pt];
+  const Bitboard empty = ~board.allPieces();
+  Bitboard pieces = board.pieces(us, pt);
   while (pieces) {
     const Square from = Bitboards::pop_lsb(pieces);
     Bitboard attacks = 0;
     switch (pt) {
       case KNIGHT:
         attacks = Bitboards::knight_attacks(from); break;
-      case BISHOP: attacks = Bitboards::bishop_attacks(from, board.allPieces); break;
-      case ROOK: attacks = Bitboards::rook_attacks(from, board.allPieces); break;
-      case QUEEN: attacks = Bitboards::queen_attacks(from, board.allPieces); break;
+      case BISHOP: attacks = Bitboards::bishop_attacks(from, board.allPieces()); break;
+      case ROOK: attacks = Bitboards::rook_attacks(from, board.allPieces()); break;
+      case QUEEN: attacks = Bitboards::queen_attacks(from, board.allPieces()); break;
       case KING: attacks = Bitboards::king_attacks(from); break;
       default: break;
     }
@@ -136,24 +136,24 @@ Move* generate_castling_moves(const Board& board, Move* move_list) {
   const Color us = board.sideToMove;
   if (board.is_in_check(us)) return move_list;
 
-  const Bitboard all = board.allPieces;
+  const Bitboard all = board.allPieces();
   const Color them = (us == WHITE) ? BLACK : WHITE;
 
   if (us == WHITE) {
-    if (board.castling.whiteKingside && (all & Bitboards::WK_EMPTY) == 0 &&
+    if (board.can_castle(WHITE_KINGSIDE) && (all & Bitboards::WK_EMPTY) == 0 &&
         !board.attacks_to(F1, them) && !board.attacks_to(G1, them)) {
       *move_list++ = Move(E1, G1, CASTLING);
     }
-    if (board.castling.whiteQueenside && (all & Bitboards::WQ_EMPTY) == 0 &&
+    if (board.can_castle(WHITE_QUEENSIDE) && (all & Bitboards::WQ_EMPTY) == 0 &&
         !board.attacks_to(D1, them) && !board.attacks_to(C1, them)) {
       *move_list++ = Move(E1, C1, CASTLING);
     }
   } else {  // BLACK
-    if (board.castling.blackKingside && (all & Bitboards::BK_EMPTY) == 0 &&
+    if (board.can_castle(BLACK_KINGSIDE) && (all & Bitboards::BK_EMPTY) == 0 &&
         !board.attacks_to(F8, them) && !board.attacks_to(G8, them)) {
       *move_list++ = Move(E8, G8, CASTLING);
     }
-    if (board.castling.blackQueenside && (all & Bitboards::BQ_EMPTY) == 0 &&
+    if (board.can_castle(BLACK_QUEENSIDE) && (all & Bitboards::BQ_EMPTY) == 0 &&
         !board.attacks_to(D8, them) && !board.attacks_to(C8, them)) {
       *move_list++ = Move(E8, C8, CASTLING);
     }
@@ -0,0 +1,138 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "packed.h"
+
+#include <fstream>
+
+#include "bitboard.h"
+#include "types.h"
+#include "zobrist.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Rook squares that go with each castling right, and the rights
+constexpr Square CASTLING_ROOK[2][2] = {{H1, A1}, {H8, A8}};
+constexpr CastlingRight CASTLING_RIGHT[2][2] = {{WHITE_KINGSIDE, WHITE_QUEENSIDE},
+                                                {BLACK_KINGSIDE, BLACK_QUEENSIDE}};
+
+}  // namespace
+
+PackedBoard PackedBoard::encode(const Board& board, int16_t score, Move move, uint8_t result,
+                                uint16_t fullmove) {
+  PackedBoard p{};
+  p.occupancy = board.allPieces();
+
+  Bitboard occ = p.occupancy;
+  for (size_t i = 0; occ; ++i) {
+    const Square sq = Bitboards::pop_lsb(occ);
+    const Color c = board.color_on(sq);
+    uint8_t code = board.piece_on(sq);
+    if (code == ROOK &&
+        ((board.can_castle(CASTLING_RIGHT[c][0]) && sq == CASTLING_ROOK[c][0]) ||
+         (board.can_castle(CASTLING_RIGHT[c][1]) && sq == CASTLING_ROOK[c][1])))
+      code = UNMOVED_ROOK;
+    code |= static_cast<uint8_t>(c << 3);
+    p.pieces[i / 2] |= static_cast<uint8_t>(code << (4 * (i % 2)));
+  }
+
+  const uint8_t ep = board.enPassant == NO_SQUARE ? 0 : static_cast<uint8_t>(board.enPassant % 8 + 1);
+  p.flags = static_cast<uint8_t>(board.sideToMove | (ep << 1) | ((result & 3) << 5));
+  p.halfmove = board.halfMoveClock;
+  p.fullmove = fullmove;
+  p.score = score;
+  p.move = move;
+  return p;
+}
+
+Board PackedBoard::decode() const {
+  Board board;
+
+  Bitboard occ = occupancy;
+  for (size_t i = 0; occ; ++i) {
+    const Square sq = Bitboards::pop_lsb(occ);
+    const uint8_t code = (pieces[i / 2] >> (4 * (i % 2))) & 0xF;
+    const Color c = Color(code >> 3);
+    const uint8_t type = code & 7;
+
+    if (type == UNMOVED_ROOK) {
+      board.put_piece(c, ROOK, sq);
+      board.castling |= CASTLING_RIGHT[c][sq == CASTLING_ROOK[c][0] ? 0 : 1];
+    } else {
+      board.put_piece(c, Piece(type), sq);
+    }
+  }
+
+  board.sideToMove = Color(flags & 1);
+  const uint8_t ep = (flags >> 1) & 0xF;
+  // The pawn that just moved belongs to the other side: rank 6 when white
+  // is to move, rank 3 otherwise
+  if (ep) board.enPassant = Square((board.sideToMove == WHITE ? 2 : 5) * 8 + ep - 1);
+
+  board.halfMoveClock = halfmove;
+  board.captured_piece = NO_PIECE;
+  board.update_checkers();
+  board.hash = Zobrist::generate_hash(board);
+  return board;
+}
+
+bool PackedReader::open(const std::string& path) {
+  close();
+
+#ifdef __linux__
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(PackedBoard))) {
+    ::close(fd);
+    return false;
+  }
+
+  const size_t bytes = static_cast<size_t>(st.st_size);
+  void* mem = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mem == MAP_FAILED) return false;
+
+  // Read front to back, let the kernel fetch ahead
+  madvise(mem, bytes, MADV_SEQUENTIAL);
+  records = static_cast<const PackedBoard*>(mem);
+  mapped_bytes = bytes;
+#else
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) return false;
+  const auto bytes = static_cast<size_t>(file.tellg());
+  if (bytes < sizeof(PackedBoard)) return false;
+  const size_t n = bytes / sizeof(PackedBoard);
+  auto* mem = new PackedBoard[n];
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(mem), static_cast<std::streamsize>(n * sizeof(PackedBoard)));
+  records = mem;
+  mapped_bytes = n * sizeof(PackedBoard);
+#endif
+
+  count = mapped_bytes / sizeof(PackedBoard);
+  return true;
+}
+
+void PackedReader::close() {
+  if (!records) return;
+#ifdef __linux__
+  munmap(const_cast<PackedBoard*>(records), mapped_bytes);
+#else
+  delete[] records;
+#endif
+  records = nullptr;
+  count = mapped_bytes = 0;
+}
@@ -0,0 +1,78 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "board.h"
+#include "move.h"
+
+/**
+ * One position in 32 bytes, for datasets. The occupied squares (our square
+ * order, A8 = bit 0) are followed by one nibble per occupied square in
+ * the same order: bit 3 is the colour, the low bits the piece type, or
+ * UNMOVED_ROOK for a rook that can still castle, which is how castling
+ * rights are stored.
+ *
+ * flags: bit 0 side to move, bits 1-4 en passant file + 1 (0 for none),
+ * bits 5-6 the game result for white (RESULT_*). Files are written in
+ * native byte order.
+ */
+struct PackedBoard {
+  static constexpr uint8_t UNMOVED_ROOK = 6;
+
+  static constexpr uint8_t RESULT_LOSS = 0;
+  static constexpr uint8_t RESULT_DRAW = 1;
+  static constexpr uint8_t RESULT_WIN = 2;
+  static constexpr uint8_t RESULT_NONE = 3;
+
+  uint64_t occupancy;
+  uint8_t pieces[16];
+  uint8_t flags;
+  uint8_t halfmove;
+  uint16_t fullmove;
+  int16_t score;  // white's point of view, optional
+  Move move;      // optional
+
+  // The board does not know its move number, so it is passed along
+  static PackedBoard encode(const Board& board, int16_t score = 0, Move move = Move(),
+                            uint8_t result = RESULT_NONE, uint16_t fullmove = 1);
+  Board decode() const;  // fullmove stays in the record
+
+  uint8_t result() const { return (flags >> 5) & 3; }
+};
+
+static_assert(sizeof(PackedBoard) == 32, "PackedBoard must stay 32 bytes");
+
+/**
+ * Read only view of a file of PackedBoard records. The file is mapped,
+ * records are used in place and only the pages that are touched get read.
+ */
+class PackedReader {
+ public:
+  PackedReader() = default;
+  ~PackedReader() { close(); }
+
+  PackedReader(const PackedReader&) = delete;
+  PackedReader& operator=(const PackedReader&) = delete;
+
+  bool open(const std::string& path);
+  void close();
+
+  size_t size() const { return count; }
+  const PackedBoard& operator[](size_t i) const { return records[i]; }
+  const PackedBoard* begin() const { return records; }
+  const PackedBoard* end() const { return records + count; }
+
+ private:
+  const PackedBoard* records = nullptr;
+  size_t count = 0;
+  size_t mapped_bytes = 0;
+};
@@ -7,31 +7,243 @@
 
 #include "search.h"
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <vector>
 
 #include "board.h"
+#include "eval_tables.h"
 #include "evaluate.h"
 #include "movegen.h"
+#include "tablebase.h"
 #include "tt.h"
 
 namespace FoChess {
 
+namespace {
+
+// Triangular PV table: pv_table[ply] holds the best line found from ply on
+thread_local std::array<PVLine, MAX_PLY + 1> pv_table;
+thread_local int seldepth = 0;
+
+// Room for positional gains on top of the captured piece in qsearch
+constexpr int DELTA_MARGIN = 200;
+
+// Appends TT moves to a PV that was cut short by a TT hit. Every position
+// is checked for repetition so that a cycle in the table cannot loop.
+void extend_pv_from_tt(PVLine& pv, const Board& root, TranspositionTable& tt) {
+  std::array<uint64_t, MAX_PLY + 1> seen;
+  Board board = root;
+  seen[0] = board.hash;
+
+  for (size_t i = 0; i < pv.length; ++i) {
+    board.makeMove(pv.moves[i]);
+    seen[i + 1] = board.hash;
+  }
+
+  while (pv.length < pv.moves.size()) {
+    TTEntry* tte = tt.probe(board.hash);
+    if (!tte) break;
+
+    Move m = tte->best_move;
+    if (!board.is_pseudo_legal(m) || !board.isLegalMove(m)) break;
+
+    board.makeMove(m);
+    if (std::find(seen.begin(), seen.begin() + pv.length + 1, board.hash) !=
+        seen.begin() + pv.length + 1)
+      break;
+
+    pv.moves[pv.length++] = m;
+    seen[pv.length] = board.hash;
+  }
+}
+
+// Searches root_moves[pv_idx..] with a full window, the moves before pv_idx
+// are the lines already found at this depth. The best move gets an exact
+// score and its PV, the others get -INF_SCORE so that the stable sort
+// keeps their order from the previous iteration. Returns the number of
+// moves that were fully searched, which is short when the search stopped.
+size_t search_root(int depth, Board& board, TranspositionTable& tt,
+                   std::vector<RootMove>& root_moves, size_t pv_idx) {
+  ThreadCounters::bump(thread_counters().main_nodes);
+
+  int alpha = -INF_SCORE;
+  const int beta = INF_SCORE;
+  size_t searched = 0;
+
+  for (size_t i = pv_idx; i < root_moves.size(); ++i) {
+    RootMove& rm = root_moves[i];
+    Board tmp = board;
+    tmp.makeMove(rm.move);
+
+    int score = -alpha_beta_pruning(depth - 1, tmp, tt, -beta, -alpha, 1);
+    if (search_state().should_stop.load(std::memory_order_relaxed)) {
+      // Whatever was not searched cannot compete with what was
+      for (size_t j = i; j < root_moves.size(); ++j)
+        root_moves[j].score = -INF_SCORE;
+      break;
+    }
+
+    if (i == pv_idx || score > alpha) {
+      alpha = score;
+      rm.score = score;
+      rm.pv.update(rm.move, pv_table[1]);
+    } else {
+      rm.score = -INF_SCORE;
+    }
+    ++searched;
+  }
+
+  std::stable_sort(root_moves.begin() + static_cast<std::ptrdiff_t>(pv_idx),
+                   root_moves.end(), [](const RootMove& a, const RootMove& b) {
+                     return a.score > b.score;
+                   });
+  return searched;
+}
+
+void publish_lines(const std::vector<RootMove>& root_moves, size_t count,
+                   const Board& board, TranspositionTable& tt) {
+  SearchStatistics& stats = search_stats();
+  stats.lines.assign(root_moves.begin(),
+                     root_moves.begin() + static_cast<std::ptrdiff_t>(count));
+  for (RootMove& line : stats.lines)
+    extend_pv_from_tt(line.pv, board, tt);
+  stats.pv = stats.lines[0].pv;
+
+  stats.best_move.store(root_moves[0].move, std::memory_order_relaxed);
+  stats.best_root_score.store(root_moves[0].score, std::memory_order_relaxed);
+  stats.seldepth.store(seldepth, std::memory_order_relaxed);
+}
+
+// Iterative deepening as run by one thread. Only the main thread (index 0)
+// publishes results and manages time, helpers search the same tree and
+// only contribute through the shared TT. Every other helper starts one
+// depth later so that the threads do not stay in lockstep.
+void search_thread(int max_depth, Board& board, TranspositionTable& tt,
+                   size_t thread_idx) {
+  const bool main_thread = thread_idx == 0;
+  SearchState& state = search_state();
+  SearchStatistics& stats = search_stats();
+  seldepth = 0;
+
+  std::array<Move, MAX_MOVES> moves;
+  size_t n = MoveGen::generate_all(board, moves);
+
+  // In a table position only the moves that keep the result (and make the
+  // most progress towards it) are searched
+  if (__builtin_popcountll(board.allPieces()) <= state.tb_probe_limit)
+    n = Tablebases::filter_root_moves(board, moves, n);
+
+  std::vector<RootMove> root_moves;
+  root_moves.reserve(n);
+  for (size_t i = 0; i < n; ++i) root_moves.emplace_back(moves[i]);
+
+  if (root_moves.empty()) {
+    if (main_thread)
+      stats.best_root_score.store(
+          board.is_in_check(board.sideToMove) ? -MATE_SCORE : 0, std::memory_order_relaxed);
+    return;
+  }
+
+  const size_t multi_pv =
+      main_thread ? std::min(root_moves.size(), static_cast<size_t>(std::max(1, state.multi_pv)))
+                  : 1;
+
+  TimeManager& tm = state.time_manager;
+
+  uint64_t nodes_before = 0;
+  for (int depth = 1 + static_cast<int>(thread_idx & 1); depth <= max_depth;
+       ++depth) {
+    if (should_stop_search()) break;
+
+    bool stopped = false;
+    for (size_t pv_idx = 0; pv_idx < multi_pv && !stopped; ++pv_idx) {
+      size_t searched = search_root(depth, board, tt, root_moves, pv_idx);
+      stopped = should_stop_search();
+
+      // An aborted iteration still counts if it got through the previous
+      // best move: whatever is first now has been searched to full depth
+      if (main_thread && stopped && pv_idx == 0 && searched > 0) {
+        publish_lines(root_moves, 1, board, tt);
+        if (state.on_iteration) state.on_iteration();
+      }
+    }
+
+    if (stopped) break;
+    if (!main_thread) continue;
+
+    const RootMove& best = root_moves[0];
+    tt.store(board.hash, best.score, best.move, static_cast<uint8_t>(depth),
+             TT_EXACT);
+
+    uint64_t nodes = stats.nodes();
+    if (depth <= static_cast<int>(MAX_STATS_DEPTH))
+      stats.depth_nodes[static_cast<size_t>(depth)].store(
+          nodes - nodes_before, std::memory_order_relaxed);
+    nodes_before = nodes;
+
+    publish_lines(root_moves, multi_pv, board, tt);
+    stats.highest_depth.store(depth, std::memory_order_relaxed);
+
+    if (state.on_iteration) state.on_iteration();
+
+    tm.on_iteration(depth, best.move, best.score);
+    if (!state.pondering.load(std::memory_order_relaxed) &&
+        tm.stop_iterating(stats.elapsed_ms(state)))
+      break;
+  }
+
+  // Stopped before depth 1 finished, any legal move beats no move
+  if (main_thread && stats.best_move.load(std::memory_order_relaxed) == Move())
+    stats.best_move.store(root_moves[0].move, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+void iterative_deepening(int max_depth, Board& board, TranspositionTable& tt,
+                         int64_t time_limit_ms) {
+  reset_search();
+  if (time_limit_ms > 0) set_time_limit(time_limit_ms);
+  search_thread(max_depth, board, tt, 0);
+  end_search();
+}
+
+void start_search(ThreadPool& pool, int max_depth, const Board& board,
+                  TranspositionTable& tt, std::function<void()> on_finish) {
+  reset_search();
+
+  SearchInstance* instance = t_search;
+  pool.run([=, &tt](size_t idx) {
+    ScopedSearch bind(*instance);
+    t_thread_idx = std::min(idx, MAX_SEARCH_THREADS - 1);
+    Board root = board;
+    search_thread(max_depth, root, tt, idx);
+
+    if (idx == 0) {
+      if (on_finish) on_finish();
+      // The main thread is done, release the helpers
+      search_state().should_stop.store(true, std::memory_order_relaxed);
+      end_search();
+    }
+  });
+}
+
 int alpha_beta_pruning(int depth, Board& board, int alpha, int beta, int ply) {
-  if ((g_search_stats.node_count.load(std::memory_order_relaxed) & 2047) == 0 &&
-      should_stop_search()) {
+  if (should_stop_search()) {
     return alpha;
   }
 
   if (depth == 0) return quiescence_search(board, alpha, beta);
 
-  FoChess::g_search_stats.node_count.fetch_add(1, std::memory_order_relaxed);
+  ThreadCounters& tc = thread_counters();
+  ThreadCounters::bump(tc.main_nodes);
 
   std::array<Move, MAX_MOVES> moves;
   size_t n = MoveGen::generate_all(board, moves);
 
   if (n == 0) [[unlikely]] {
-    if (board.is_in_check(board.sideToMove)) return -MATE_SCORE;
+    if (board.is_in_check(board.sideToMove)) return -MATE_SCORE + ply;
     return 0;
   }
 
@@ -49,22 +261,26 @@ int alpha_beta_pruning(int depth, Board& board, int alpha, int beta, int ply) {
     }
 
     alpha = std::max(alpha, score);
-    if (alpha >= beta) break;
+    if (alpha >= beta) {
+      tc.on_cutoff(i);
+      break;
+    }
   }
 
   if (ply == 0) {
-    g_search_stats.best_move.store(best_move, std::memory_order_relaxed);
-    g_search_stats.best_root_score.store(best, std::memory_order_relaxed);
+    search_stats().best_move.store(best_move, std::memory_order_relaxed);
+    search_stats().best_root_score.store(best, std::memory_order_relaxed);
   }
 
   return best;
 }
 
 int quiescence_search(Board& board, int alpha, int beta) {
-  if ((g_search_stats.node_count.load(std::memory_order_relaxed) & 2047) == 0 &&
-      should_stop_search())
+  if (should_stop_search())
     return bland_evaluate(board);
 
+  ThreadCounters::bump(thread_counters().qnodes);
+
   // Stand pat
   int stand_pat = bland_evaluate(board);
   if (stand_pat >= beta) return stand_pat;
@@ -88,98 +304,197 @@ int quiescence_search(Board& board, int alpha, int beta) {
 
 int alpha_beta_pruning(int depth, Board& board, TranspositionTable& tt,
                        int alpha, int beta, int ply) {
-  if ((g_search_stats.node_count.load(std::memory_order_relaxed) & 2047) == 0 &&
-      should_stop_search())
+  if (should_stop_search())
     return alpha;
 
+  pv_table[static_cast<size_t>(ply)].length = 0;
+  if (ply >= MAX_PLY) return bland_evaluate(board);
+
+  // Before the hash table: the qsearch probes it for itself, and the
+  // tablebases are never probed at depth 0
+  if (depth == 0) return quiescence_search(board, tt, alpha, beta, ply);
+
+  ThreadCounters& tc = thread_counters();
   const uint64_t hash_key = board.hash;
   TTEntry* tte = tt.probe(hash_key);
+  ThreadCounters::bump(tc.tt_probes);
 
+  // A colliding entry can hold any move, it is only trusted once vetted
   Move tt_move = Move();
+  bool tt_move_ok = false;
   if (tte) {
+    ThreadCounters::bump(tc.tt_hits);
     tt_move = tte->best_move;
-    if (tte->depth >= depth && board.moveExists(tt_move) &&
-        board.isLegalMove(tt_move)) {
-      if (tte->flag == TT_EXACT) return tte->score;
-      if (tte->flag == TT_ALPHA && tte->score <= alpha) return tte->score;
-      if (tte->flag == TT_BETA && tte->score >= beta) return tte->score;
+    tt_move_ok = board.is_pseudo_legal(tt_move) && board.isLegalMove(tt_move);
+    // Never cut at the root, it must always produce a move and a PV.
+    // Tablebase results are stored without one.
+    if (ply > 0 && tte->depth >= depth && (tt_move_ok || tt_move == Move())) {
+      const int tt_score = score_from_tt(tte->score, ply);
+      if (tte->flag == TT_EXACT ||
+          (tte->flag == TT_ALPHA && tt_score <= alpha) ||
+          (tte->flag == TT_BETA && tt_score >= beta)) {
+        ThreadCounters::bump(tc.tt_cutoffs);
+        return tt_score;
+      }
     }
   }
 
-  if (depth == 0) return quiescence_search(board, tt, alpha, beta);
-
-  FoChess::g_search_stats.node_count.fetch_add(1, std::memory_order_relaxed);
-
-  std::array<Move, MAX_MOVES> moves;
-  size_t n = MoveGen::generate_all(board, moves);
-  if (n == 0)
-    return (board.is_in_check(board.sideToMove)) ? -MATE_SCORE + ply : 0;
-
-  if (board.moveExists(tt_move) && board.isLegalMove(tt_move)) {
-    auto it = std::find(moves.begin(), moves.begin() + n, tt_move);
-    if (it != moves.begin() + n) std::iter_swap(moves.begin(), it);
+  // The tables are exact, nothing below them needs searching. Their
+  // results assume a fresh 50-move count, so only probe right after a
+  // capture or pawn move. Cursed wins and blessed losses are draws, one
+  // centipawn off.
+  if (ply > 0 && board.halfMoveClock == 0 && depth >= search_state().tb_probe_depth &&
+      __builtin_popcountll(board.allPieces()) <= search_state().tb_probe_limit) {
+    Tablebases::WDL wdl;
+    if (Tablebases::probe_wdl(board, wdl)) {
+      ThreadCounters::bump(tc.tb_hits);
+      const int score = wdl == Tablebases::WDL_WIN    ? TB_WIN_SCORE - ply
+                        : wdl == Tablebases::WDL_LOSS ? -TB_WIN_SCORE + ply
+                                                      : static_cast<int>(wdl);
+      tt.store(hash_key, score_to_tt(score, ply), Move(), static_cast<uint8_t>(depth), TT_EXACT);
+      return score;
+    }
   }
 
+  ThreadCounters::bump(tc.main_nodes);
+  check_node_limit(tc.main_nodes.load(std::memory_order_relaxed));
+
   int best = -INF_SCORE;
   Move best_move;
 
   TTFlag flag = TT_ALPHA;
 
-  for (size_t i = 0; i < n; ++i) {
+  // Searches the i-th move tried, true on a beta cutoff
+  auto search_move = [&](const Move& m, size_t i) {
+    // The child probes the TT first thing, start that load now
+    tt.prefetch(board.key_after(m));
     Board tmp = board;
-    tmp.makeMove(moves[i]);
+    tmp.makeMove(m);
 
     int score = -alpha_beta_pruning(depth - 1, tmp, tt, -beta, -alpha, ply + 1);
 
     if (score > best) {
       best = score;
-      best_move = moves[i];
+      best_move = m;
 
       if (ply == 0)
-        g_search_stats.best_move.store(best_move, std::memory_order_relaxed);
+        search_stats().best_move.store(best_move, std::memory_order_relaxed);
       if (score > alpha) {
         alpha = score;
         flag = TT_EXACT;
+        pv_table[static_cast<size_t>(ply)].update(
+            best_move, pv_table[static_cast<size_t>(ply) + 1]);
         if (score >= beta) {
+          tc.on_cutoff(i);
           flag = TT_BETA;
-          tt.store(hash_key, best, best_move, static_cast<uint8_t>(depth), flag);
-          break;
+          return true;
         }
       }
     }
+    return false;
+  };
+
+  // The hash move goes first, before anything is generated: when it cuts
+  // the move list is never built
+  bool cutoff = tt_move_ok && search_move(tt_move, 0);
+
+  if (!cutoff) {
+    std::array<Move, MAX_MOVES> moves;
+    size_t n = MoveGen::generate_all(board, moves);
+    if (n == 0)
+      return (board.is_in_check(board.sideToMove)) ? -MATE_SCORE + ply : 0;
+
+    size_t tried = tt_move_ok;
+    for (size_t i = 0; i < n && !cutoff; ++i)
+      if (!tt_move_ok || moves[i] != tt_move) cutoff = search_move(moves[i], tried++);
   }
 
-  tt.store(hash_key, best, best_move, static_cast<uint8_t>(depth), flag);
+  // Children cut short by a stop return garbage, keep it out of the table
+  if (should_stop_search()) return best;
+
+  tt.store(hash_key, score_to_tt(best, ply), best_move,
+           static_cast<uint8_t>(depth), flag);
   return best;
 }
 
 int quiescence_search(Board& board, TranspositionTable& tt, int alpha,
-                      int beta) {
-  if ((g_search_stats.node_count.load(std::memory_order_relaxed) & 2047) == 0 &&
-      should_stop_search()) {
+                      int beta, int ply) {
+  if (should_stop_search()) {
     return bland_evaluate(board);
   }
 
-  FoChess::g_search_stats.node_count.fetch_add(1, std::memory_order_relaxed);
+  if (ply > seldepth) seldepth = ply;
+  if (ply >= MAX_PLY) return bland_evaluate(board);
 
-  // Stand pat
-  int stand_pat = bland_evaluate(board);
-  if (stand_pat >= beta) return beta;
+  ThreadCounters& tc = thread_counters();
+  ThreadCounters::bump(tc.qnodes);
+  check_node_limit(tc.qnodes.load(std::memory_order_relaxed));
+
+  // Any entry is at least as deep as a qsearch, so its bounds apply as is
+  const uint64_t hash_key = board.hash;
+  TTEntry* tte = tt.probe(hash_key);
+  ThreadCounters::bump(tc.tt_probes);
+
+  Move tt_move = Move();
+  int stand_pat = TT_NO_EVAL;
+  if (tte) {
+    ThreadCounters::bump(tc.tt_hits);
+    const int tt_score = score_from_tt(tte->score, ply);
+    if (tte->flag == TT_EXACT || (tte->flag == TT_ALPHA && tt_score <= alpha) ||
+        (tte->flag == TT_BETA && tt_score >= beta)) {
+      ThreadCounters::bump(tc.tt_cutoffs);
+      return tt_score;
+    }
+    tt_move = tte->best_move;
+    stand_pat = tte->eval;
+  }
+
+  // Stand pat, fail soft
+  if (stand_pat == TT_NO_EVAL) stand_pat = bland_evaluate(board);
+  if (stand_pat >= beta) {
+    tt.store(hash_key, score_to_tt(stand_pat, ply), Move(), 0, TT_BETA, stand_pat);
+    return stand_pat;
+  }
+  const int old_alpha = alpha;
   if (stand_pat > alpha) alpha = stand_pat;
 
   std::array<Move, MAX_MOVES> moves;
   size_t n = MoveGen::generate_captures(board, moves);
 
+  auto it = std::find(moves.begin(), moves.begin() + n, tt_move);
+  if (it != moves.begin() + n) std::iter_swap(moves.begin(), it);
+
+  int best = stand_pat;
+  Move best_move;
+
   for (size_t i = 0; i < n; ++i) {
+    const Move m = moves[i];
+    // Delta pruning: even winning the piece for free cannot reach alpha
+    if (m.type() != MoveType::PROMOTION) {
+      const Piece captured = m.type() == MoveType::EN_PASSANT ? PAWN : board.piece_on(m.to_sq());
+      if (stand_pat + piece_values[captured] + DELTA_MARGIN <= alpha) continue;
+    }
+
+    tt.prefetch(board.key_after(m));
     Board tmp = board;
-    tmp.makeMove(moves[i]);
-    int score = -quiescence_search(tmp, tt, -beta, -alpha);
+    tmp.makeMove(m);
+    int score = -quiescence_search(tmp, tt, -beta, -alpha, ply + 1);
 
-    if (score >= beta) return beta;
-    if (score > alpha) alpha = score;
+    if (score > best) {
+      best = score;
+      if (score > alpha) {
+        alpha = score;
+        best_move = m;
+        if (score >= beta) break;
+      }
+    }
   }
 
-  return alpha;
+  if (should_stop_search()) return best;
+
+  const TTFlag flag = best >= beta ? TT_BETA : best > old_alpha ? TT_EXACT : TT_ALPHA;
+  tt.store(hash_key, score_to_tt(best, ply), best_move, 0, flag, stand_pat);
+  return best;
 }
 
 }  // namespace FoChess
@@ -6,31 +6,146 @@
 // -----------------------------------------------------------------------------
 
 #pragma once
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <functional>
+#include <vector>
 
 #include "board.h"
 #include "move.h"
+#include "stats.h"
+#include "thread.h"
+#include "timeman.h"
 #include "tt.h"
 
 namespace FoChess {
 
 constexpr int MATE_SCORE = 10000000;
 constexpr int INF_SCORE = 2 * MATE_SCORE;
+constexpr int MAX_PLY = 128;
+constexpr int MATE_BOUND = MATE_SCORE - MAX_PLY;
+
+// Tablebase wins, above any evaluation and below every mate
+constexpr int TB_WIN_SCORE = 20000;
+constexpr int TB_WIN_BOUND = TB_WIN_SCORE - MAX_PLY;
+
+constexpr bool is_mate_score(int score) {
+  return score >= MATE_BOUND || score <= -MATE_BOUND;
+}
+
+// Full moves to mate, negative when we are the ones getting mated
+constexpr int mate_in(int score) {
+  return score > 0 ? (MATE_SCORE - score + 1) / 2 : -(MATE_SCORE + score) / 2;
+}
+
+// Mate and tablebase scores are stored relative to the node, not to the
+// root
+constexpr int score_to_tt(int score, int ply) {
+  if (score >= TB_WIN_BOUND) return score + ply;
+  if (score <= -TB_WIN_BOUND) return score - ply;
+  return score;
+}
+
+constexpr int score_from_tt(int score, int ply) {
+  if (score >= TB_WIN_BOUND) return score - ply;
+  if (score <= -TB_WIN_BOUND) return score + ply;
+  return score;
+}
+
+struct PVLine {
+  std::array<Move, MAX_PLY> moves{};
+  size_t length = 0;
+
+  void update(Move m, const PVLine& child) {
+    moves[0] = m;
+    size_t n = std::min(child.length, moves.size() - 1);
+    std::copy_n(child.moves.begin(), n, moves.begin() + 1);
+    length = n + 1;
+  }
+};
+
+// Root moves keep their order between iterations, so that each new depth
+// starts from the best lines of the previous one
+struct RootMove {
+  explicit RootMove(Move m) : move(m) {}
+
+  Move move;
+  int score = -INF_SCORE;
+  PVLine pv;
+};
 
 struct SearchState {
   std::atomic<bool> searching{false};
   std::chrono::steady_clock::time_point search_start;
   std::atomic<int64_t> time_limit{0};
-  std::atomic<bool> should_stop{false};
+  std::atomic<bool> pondering{false};
+
+  // Read by every node of every thread, so it gets a cache line of its own
+  // that nobody writes until the search has to stop
+  alignas(64) std::atomic<bool> should_stop{false};
+  alignas(64) Watchdog watchdog{should_stop};
+
+  // Soft/hard limits for timed searches, the hard one goes through
+  // set_time_limit() once the search has started
+  TimeManager time_manager;
+
+  // Number of principal variations to search, set before the search starts
+  int multi_pv = 1;
+
+  // Stop after about this many nodes, 0 for no limit
+  uint64_t node_limit = 0;
+
+  // Endgame tables are probed with at most this many pieces on the board,
+  // and only with at least tb_probe_depth plies left
+  int tb_probe_limit = 7;
+  int tb_probe_depth = 1;
+
+  // Called by the searching thread after every completed iteration
+  std::function<void()> on_iteration;
 };
 
 struct SearchStatistics {
-  std::atomic<uint64_t> node_count{0};
   std::atomic<int> highest_depth{0};
   std::atomic<int> best_root_score{-INF_SCORE};
   std::atomic<Move> best_move{Move{}};
+  std::atomic<int> seldepth{0};
+
+  // Principal variation and the MultiPV lines of the last completed
+  // iteration, only written by the searching thread between iterations
+  PVLine pv;
+  std::vector<RootMove> lines;
+
+  // Detailed counters, one slot per search thread
+  std::array<ThreadCounters, MAX_SEARCH_THREADS> threads;
+  std::array<std::atomic<uint64_t>, MAX_STATS_DEPTH + 1> depth_nodes{};
+
+  // Nodes are only counted per thread, this sums them on demand
+  uint64_t tb_hits() const {
+    uint64_t total = 0;
+    for (const auto& t : threads) total += t.tb_hits.load(std::memory_order_relaxed);
+    return total;
+  }
+
+  uint64_t nodes() const {
+    uint64_t total = 0;
+    for (const auto& t : threads)
+      total += t.main_nodes.load(std::memory_order_relaxed) +
+               t.qnodes.load(std::memory_order_relaxed);
+    return total;
+  }
+
+  StatsSnapshot snapshot() const {
+    StatsSnapshot s;
+    for (const auto& t : threads) s.add(t);
+    s.completed_depth = std::min<int>(
+        highest_depth.load(std::memory_order_relaxed), MAX_STATS_DEPTH);
+    for (size_t d = 0; d <= MAX_STATS_DEPTH; ++d)
+      s.depth_nodes[d] = depth_nodes[d].load(std::memory_order_relaxed);
+    return s;
+  }
 
   int64_t elapsed_ms(const SearchState& state) const {
     return std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -40,20 +155,63 @@ struct SearchStatistics {
 
   double nps(const SearchState& state) const {
     int64_t time_ms = elapsed_ms(state);
-    uint64_t nodes = node_count.load(std::memory_order_relaxed);
-    return time_ms > 0 ? (static_cast<double>(nodes) * 1000.0) /
+    return time_ms > 0 ? (static_cast<double>(nodes()) * 1000.0) /
                              static_cast<double>(time_ms)
                        : 0.0;
   }
 };
 
-inline SearchState g_search_state;
-inline SearchStatistics g_search_stats;
+// Everything a search writes besides its TT. The engine has one global
+// instance; tools that run independent searches side by side give every
+// thread its own and bind it with ScopedSearch.
+struct SearchInstance {
+  SearchState state;
+  SearchStatistics stats;
+};
+
+inline SearchInstance g_search;
+inline SearchState& g_search_state = g_search.state;
+inline SearchStatistics& g_search_stats = g_search.stats;
+
+// Instance the calling thread searches with
+inline thread_local SearchInstance* t_search = &g_search;
+
+inline SearchState& search_state() { return t_search->state; }
+inline SearchStatistics& search_stats() { return t_search->stats; }
+
+// Binds an instance to the calling thread for the lifetime of the guard
+class ScopedSearch {
+ public:
+  explicit ScopedSearch(SearchInstance& instance) : previous(t_search) {
+    t_search = &instance;
+  }
+  ~ScopedSearch() { t_search = previous; }
+
+  ScopedSearch(const ScopedSearch&) = delete;
+  ScopedSearch& operator=(const ScopedSearch&) = delete;
+
+ private:
+  SearchInstance* previous;
+};
+
+// Index of the counters slot the calling thread writes to
+inline thread_local size_t t_thread_idx = 0;
+
+inline ThreadCounters& thread_counters() {
+  return search_stats().threads[t_thread_idx];
+}
 
 void reset_search();
 void end_search();
 bool should_stop_search();
 
+// Called with a thread's own node count after every node. The total is
+// only summed every 256 nodes, which is as precise as a limit needs to be.
+void check_node_limit(uint64_t thread_nodes);
+
+// Stops the current search limit_ms after it started, 0 removes the limit
+void set_time_limit(int64_t limit_ms);
+
 int bland_evaluate(const Board& board);
 
 // Version without TT
@@ -65,63 +223,66 @@ int alpha_beta_pruning(int depth, Board& board, TranspositionTable& tt,
                        int alpha = -INF_SCORE, int beta = INF_SCORE,
                        int ply = 0);
 
-void iterative_deepening(int max_depth, Board& board, TranspositionTable& tt);
+// Searches on the calling thread until max_depth, or until time_limit_ms
+// when it is set
+void iterative_deepening(int max_depth, Board& board, TranspositionTable& tt,
+                         int64_t time_limit_ms = 0);
+
+// Searches on every worker of the pool, worker 0 being the main thread that
+// reports results; on_finish runs on it once its search is over. The
+// workers use the caller's search instance. Returns immediately,
+// pool.wait() blocks until all workers are done.
+void start_search(ThreadPool& pool, int max_depth, const Board& board,
+                  TranspositionTable& tt, std::function<void()> on_finish = {});
 
 int quiescence_search(Board& board, int alpha, int beta);
 int quiescence_search(Board& board, TranspositionTable& tt, int alpha,
-                      int beta);
+                      int beta, int ply = 0);
 
 }  // namespace FoChess
 
 inline void FoChess::reset_search() {
-  // State
-  g_search_state.searching.store(true, std::memory_order_relaxed);
-  g_search_state.search_start = std::chrono::steady_clock::now();
-  // g_search_state.time_limit.store(0, std::memory_order_relaxed);
-  g_search_state.should_stop.store(false, std::memory_order_relaxed);
+  SearchState& state = search_state();
+  SearchStatistics& stats = search_stats();
+
+  // State, the old deadline must not fire into the new search
+  state.watchdog.disarm();
+  state.time_limit.store(0, std::memory_order_relaxed);
+  state.searching.store(true, std::memory_order_relaxed);
+  state.search_start = std::chrono::steady_clock::now();
+  state.should_stop.store(false, std::memory_order_relaxed);
 
   // Statistics
-  g_search_stats.node_count.store(0, std::memory_order_relaxed);
-  g_search_stats.highest_depth.store(0, std::memory_order_relaxed);
-  g_search_stats.best_root_score.store(INT_MIN + 1, std::memory_order_relaxed);
-  g_search_stats.best_move.store(Move{}, std::memory_order_relaxed);
+  stats.highest_depth.store(0, std::memory_order_relaxed);
+  stats.best_root_score.store(INT_MIN + 1, std::memory_order_relaxed);
+  stats.best_move.store(Move{}, std::memory_order_relaxed);
+  stats.seldepth.store(0, std::memory_order_relaxed);
+  stats.pv.length = 0;
+  stats.lines.clear();
+  for (auto& t : stats.threads) t.clear();
+  for (auto& d : stats.depth_nodes) d.store(0, std::memory_order_relaxed);
 }
 
 inline void FoChess::end_search() {
-  g_search_state.searching.store(false, std::memory_order_relaxed);
+  search_state().searching.store(false, std::memory_order_relaxed);
 }
 
 inline bool FoChess::should_stop_search() {
-  if (g_search_state.should_stop.load(std::memory_order_relaxed)) return true;
-
-  // Check time limit if set
-  if (g_search_state.time_limit.load(std::memory_order_relaxed) > 0) {
-    auto elapsed =
-        std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - g_search_state.search_start)
-            .count();
-    if (elapsed >= g_search_state.time_limit.load(std::memory_order_relaxed)) {
-      g_search_state.should_stop.store(true, std::memory_order_relaxed);
-      return true;
-    }
-  }
-  return false;
+  return search_state().should_stop.load(std::memory_order_relaxed);
 }
 
-inline void FoChess::iterative_deepening(int max_depth, Board& board,
-                                         TranspositionTable& tt) {
-  reset_search();
-
-  for (int depth = 1; depth <= max_depth; ++depth) {
-    if (should_stop_search()) break;
-
-    int score = alpha_beta_pruning(depth, board, tt, -INF_SCORE, INF_SCORE);
-
-    if (should_stop_search()) break;
-
-    g_search_stats.highest_depth.store(depth, std::memory_order_relaxed);
-    g_search_stats.best_root_score.store(score, std::memory_order_relaxed);
-  }
+inline void FoChess::check_node_limit(uint64_t thread_nodes) {
+  if (thread_nodes & 255) return;
+  SearchInstance& search = *t_search;
+  if (search.state.node_limit && search.stats.nodes() >= search.state.node_limit)
+    search.state.should_stop.store(true, std::memory_order_relaxed);
+}
 
-  end_search();
+inline void FoChess::set_time_limit(int64_t limit_ms) {
+  SearchState& state = search_state();
+  state.time_limit.store(limit_ms, std::memory_order_relaxed);
+  if (limit_ms > 0)
+    state.watchdog.arm(state.search_start + std::chrono::milliseconds(limit_ms));
+  else
+    state.watchdog.disarm();
 }
@@ -0,0 +1,151 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+namespace FoChess {
+
+constexpr size_t MAX_SEARCH_THREADS = 64;
+constexpr size_t MAX_STATS_DEPTH = 64;
+constexpr size_t CUTOFF_BUCKETS = 16;  // last bucket collects index >= 15
+
+/**
+ * Plain counters written by exactly one search thread. They are atomics only
+ * so that the reporting thread can read them without a data race; every
+ * update is a relaxed load + store, which compiles to a normal increment
+ * and never locks the cache line.
+ */
+struct alignas(64) ThreadCounters {
+  std::atomic<uint64_t> main_nodes{0};
+  std::atomic<uint64_t> qnodes{0};
+  std::atomic<uint64_t> tt_probes{0};
+  std::atomic<uint64_t> tt_hits{0};
+  std::atomic<uint64_t> tt_cutoffs{0};
+  std::atomic<uint64_t> fail_highs{0};
+  std::atomic<uint64_t> tb_hits{0};
+  std::array<std::atomic<uint64_t>, CUTOFF_BUCKETS> cutoff_index{};
+
+  static void bump(std::atomic<uint64_t>& c) noexcept {
+    c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  void on_cutoff(size_t move_index) noexcept {
+    bump(fail_highs);
+    bump(cutoff_index[move_index < CUTOFF_BUCKETS ? move_index
+                                                  : CUTOFF_BUCKETS - 1]);
+  }
+
+  void clear() noexcept {
+    main_nodes.store(0, std::memory_order_relaxed);
+    qnodes.store(0, std::memory_order_relaxed);
+    tt_probes.store(0, std::memory_order_relaxed);
+    tt_hits.store(0, std::memory_order_relaxed);
+    tt_cutoffs.store(0, std::memory_order_relaxed);
+    fail_highs.store(0, std::memory_order_relaxed);
+    tb_hits.store(0, std::memory_order_relaxed);
+    for (auto& c : cutoff_index) c.store(0, std::memory_order_relaxed);
+  }
+};
+
+/**
+ * Merged copy of every thread's counters plus the per-iteration node
+ * counts, taken at report time. This is what gets printed.
+ */
+struct StatsSnapshot {
+  uint64_t main_nodes = 0;
+  uint64_t qnodes = 0;
+  uint64_t tt_probes = 0;
+  uint64_t tt_hits = 0;
+  uint64_t tt_cutoffs = 0;
+  uint64_t fail_highs = 0;
+  uint64_t tb_hits = 0;
+  std::array<uint64_t, CUTOFF_BUCKETS> cutoff_index{};
+  std::array<uint64_t, MAX_STATS_DEPTH + 1> depth_nodes{};
+  int completed_depth = 0;
+
+  void add(const ThreadCounters& t) {
+    main_nodes += t.main_nodes.load(std::memory_order_relaxed);
+    qnodes += t.qnodes.load(std::memory_order_relaxed);
+    tt_probes += t.tt_probes.load(std::memory_order_relaxed);
+    tt_hits += t.tt_hits.load(std::memory_order_relaxed);
+    tt_cutoffs += t.tt_cutoffs.load(std::memory_order_relaxed);
+    fail_highs += t.fail_highs.load(std::memory_order_relaxed);
+    tb_hits += t.tb_hits.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < CUTOFF_BUCKETS; ++i)
+      cutoff_index[i] += t.cutoff_index[i].load(std::memory_order_relaxed);
+  }
+
+  static double ratio(uint64_t num, uint64_t den) {
+    return den ? static_cast<double>(num) / static_cast<double>(den) : 0.0;
+  }
+
+  double tt_hit_rate() const { return ratio(tt_hits, tt_probes); }
+  double first_move_cutoff_rate() const {
+    return ratio(cutoff_index[0], fail_highs);
+  }
+
+  // Effective branching factor between two completed iterations
+  double branching_factor(int depth) const {
+    if (depth < 2 || depth > completed_depth) return 0.0;
+    return ratio(depth_nodes[static_cast<size_t>(depth)],
+                 depth_nodes[static_cast<size_t>(depth - 1)]);
+  }
+
+  // One line per topic so that each fits in a single "info string"
+  std::string to_info_string() const {
+    std::ostringstream os;
+    os << "info string nodes main " << main_nodes << " qsearch " << qnodes
+       << "\n";
+    os << "info string tt probes " << tt_probes << " hits " << tt_hits
+       << " cutoffs " << tt_cutoffs << " hitrate " << tt_hit_rate() << "\n";
+    os << "info string failhigh " << fail_highs << " first "
+       << first_move_cutoff_rate() << "\n";
+    os << "info string tbhits " << tb_hits << "\n";
+    os << "info string cutoff index";
+    for (uint64_t c : cutoff_index) os << ' ' << c;
+    os << "\n";
+    os << "info string depth nodes";
+    for (int d = 1; d <= completed_depth; ++d)
+      os << ' ' << d << ':' << depth_nodes[static_cast<size_t>(d)];
+    os << "\n";
+    os << "info string branching";
+    for (int d = 2; d <= completed_depth; ++d)
+      os << ' ' << d << ':' << branching_factor(d);
+    os << "\n";
+    return os.str();
+  }
+
+  std::string to_json() const {
+    std::ostringstream os;
+    os << "{\"main_nodes\":" << main_nodes << ",\"qnodes\":" << qnodes
+       << ",\"tt\":{\"probes\":" << tt_probes << ",\"hits\":" << tt_hits
+       << ",\"cutoffs\":" << tt_cutoffs << ",\"hit_rate\":" << tt_hit_rate()
+       << "},\"fail_highs\":" << fail_highs
+       << ",\"first_move_fail_high_rate\":" << first_move_cutoff_rate()
+       << ",\"tb_hits\":" << tb_hits
+       << ",\"cutoff_index\":[";
+    for (size_t i = 0; i < CUTOFF_BUCKETS; ++i)
+      os << (i ? "," : "") << cutoff_index[i];
+    os << "],\"depths\":[";
+    for (int d = 1; d <= completed_depth; ++d) {
+      os << (d > 1 ? "," : "") << "{\"depth\":" << d << ",\"nodes\":"
+         << depth_nodes[static_cast<size_t>(d)]
+         << ",\"branching_factor\":" << branching_factor(d) << "}";
+    }
+    os << "]}";
+    return os.str();
+  }
+};
+
+}  // namespace FoChess
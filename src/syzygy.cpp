@@ -0,0 +1,345 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "syzygy.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "bitboard.h"
+
+namespace Syzygy {
+
+namespace {
+
+constexpr int rank_of(int sq) { return sq >> 3; }
+constexpr int file_of(int sq) { return sq & 7; }
+
+// Positive above the A1-H8 diagonal, negative below, 0 on it
+constexpr int off_diagonal(int sq) { return rank_of(sq) - file_of(sq); }
+
+bool kings_touch(int s1, int s2) {
+  const Square ours = Square(s1 ^ 56);
+  return ((Bitboards::king_attacks(ours) | Bitboards::square_bb(ours)) &
+          Bitboards::square_bb(Square(s2 ^ 56))) != 0;
+}
+
+struct Tables {
+  int map_b1h1h7[64] = {};  // squares below the diagonal, 0..27
+  int map_a1d1d4[64] = {};  // the A1-D1-D4 triangle, diagonal last, 0..9
+  int map_kk[10][64] = {};  // the 462 placements of two kings
+  uint64_t binomial[MAX_PIECES][64] = {};
+  int map_pawns[64] = {};
+  int lead_pawn_idx[6][64] = {};
+  int lead_pawns_size[6][4] = {};
+
+  Tables() {
+    int code = 0;
+    for (int s = 0; s < 64; ++s)
+      if (off_diagonal(s) < 0) map_b1h1h7[s] = code++;
+
+    std::vector<int> diagonal;
+    code = 0;
+    for (int s = 0; s <= 27; ++s) {
+      if (file_of(s) > 3) continue;
+      if (off_diagonal(s) < 0)
+        map_a1d1d4[s] = code++;
+      else if (off_diagonal(s) == 0)
+        diagonal.push_back(s);
+    }
+    for (int s : diagonal) map_a1d1d4[s] = code++;
+
+    // With the first king on the diagonal the second one is never above it
+    std::vector<std::pair<int, int>> both_on_diagonal;
+    code = 0;
+    for (int idx = 0; idx < 10; ++idx)
+      for (int s1 = 0; s1 <= 27; ++s1) {
+        if (file_of(s1) > 3 || off_diagonal(s1) > 0 || map_a1d1d4[s1] != idx ||
+            (idx == 0 && s1 != 1))  // B1 is the one mapped to 0
+          continue;
+        for (int s2 = 0; s2 < 64; ++s2) {
+          if (kings_touch(s1, s2)) continue;
+          if (!off_diagonal(s1) && off_diagonal(s2) > 0) continue;
+          if (!off_diagonal(s1) && !off_diagonal(s2))
+            both_on_diagonal.emplace_back(idx, s2);
+          else
+            map_kk[idx][s2] = code++;
+        }
+      }
+    for (const auto& [idx, s2] : both_on_diagonal) map_kk[idx][s2] = code++;
+
+    binomial[0][0] = 1;
+    for (int n = 1; n < 64; ++n)
+      for (int k = 0; k < MAX_PIECES && k <= n; ++k)
+        binomial[k][n] = (k > 0 ? binomial[k - 1][n - 1] : 0) +
+                         (k < n ? binomial[k][n - 1] : 0);
+
+    // The leading pawn is the one nearest the edge, and the lowest rank
+    // among those: it has the highest map_pawns
+    int available = 47;
+    for (int lead = 1; lead <= 5; ++lead)
+      for (int f = 0; f < 4; ++f) {
+        int idx = 0;
+        for (int r = 1; r <= 6; ++r) {
+          const int sq = r * 8 + f;
+          if (lead == 1) {
+            map_pawns[sq] = available--;
+            map_pawns[sq ^ 7] = available--;
+          }
+          lead_pawn_idx[lead][sq] = idx;
+          idx += static_cast<int>(binomial[lead - 1][map_pawns[sq]]);
+        }
+        lead_pawns_size[lead][f] = idx;
+      }
+  }
+};
+
+const Tables& tables() {
+  static const Tables t;
+  return t;
+}
+
+bool pawns_before(int a, int b) {
+  return tables().map_pawns[a] < tables().map_pawns[b];
+}
+
+uint64_t pack(const int counts[2][6]) {
+  uint64_t key = 0;
+  for (int c = WHITE; c <= BLACK; ++c)
+    for (int pt = PAWN; pt < KING; ++pt)
+      key |= static_cast<uint64_t>(counts[c][pt]) << (4 * (6 * c + pt));
+  return key;
+}
+
+constexpr char PIECE_CHARS[] = "PNBRQK";
+
+int piece_of(char c) {
+  for (int pt = PAWN; pt <= KING; ++pt)
+    if (PIECE_CHARS[pt] == c) return pt;
+  return -1;
+}
+
+std::string side_name(const int counts[6]) {
+  std::string s = "K";
+  for (int pt = QUEEN; pt >= PAWN; --pt)
+    s.append(static_cast<size_t>(counts[pt]), PIECE_CHARS[pt]);
+  return s;
+}
+
+// More pieces first, then the heavier pieces, ties are not stronger
+bool stronger(const std::string& a, const std::string& b) {
+  if (a.size() != b.size()) return a.size() > b.size();
+  for (size_t i = 0; i < a.size(); ++i)
+    if (a[i] != b[i]) return piece_of(a[i]) > piece_of(b[i]);
+  return false;
+}
+
+}  // namespace
+
+uint64_t material_key(const Board& board, bool swap_colors) {
+  int counts[2][6] = {};
+  for (int c = WHITE; c <= BLACK; ++c)
+    for (int pt = PAWN; pt < KING; ++pt)
+      counts[c ^ swap_colors][pt] =
+          Bitboards::popcount(board.pieces(Color(c), Piece(pt)));
+  return pack(counts);
+}
+
+std::string table_name(const int counts[2][6]) {
+  const std::string w = side_name(counts[WHITE]), b = side_name(counts[BLACK]);
+  return stronger(b, w) ? b + "v" + w : w + "v" + b;
+}
+
+bool parse_material(const std::string& name, Material& m) {
+  const size_t v = name.find('v');
+  if (v == std::string::npos || name.size() > MAX_PIECES + 1) return false;
+
+  int counts[2][6] = {};
+  for (size_t i = 0; i < name.size(); ++i) {
+    if (i == v) continue;
+    const int pt = piece_of(name[i]);
+    const bool first = i == 0 || i == v + 1;
+    if (pt < 0 || (pt == KING) != first) return false;
+    ++counts[i < v ? WHITE : BLACK][pt];
+  }
+  if (counts[WHITE][KING] != 1 || counts[BLACK][KING] != 1) return false;
+
+  int swapped[2][6];
+  for (int pt = PAWN; pt <= KING; ++pt) {
+    swapped[WHITE][pt] = counts[BLACK][pt];
+    swapped[BLACK][pt] = counts[WHITE][pt];
+  }
+
+  m = Material();
+  m.name = name;
+  std::copy(&counts[0][0], &counts[0][0] + 12, &m.counts[0][0]);
+  m.key = pack(counts);
+  m.key2 = pack(swapped);
+  m.pieceCount = static_cast<int>(name.size()) - 1;
+  for (int c = WHITE; c <= BLACK; ++c)
+    for (int pt = PAWN; pt < KING; ++pt)
+      if (counts[c][pt] == 1) m.hasUniquePieces = true;
+
+  const int white = counts[WHITE][PAWN], black = counts[BLACK][PAWN];
+  m.hasPawns = white + black > 0;
+  if (m.hasPawns) {
+    m.leadColor = !black || (white && black >= white) ? WHITE : BLACK;
+    m.pawnCount[0] = m.leadColor == WHITE ? white : black;
+    m.pawnCount[1] = m.leadColor == WHITE ? black : white;
+  }
+  return true;
+}
+
+uint64_t set_groups(const Material& m, Layout& l, const int order[2], int file) {
+  const Tables& t = tables();
+
+  // Pieces are grouped with their equals, the leading group being the
+  // leading pawns, three unique pieces or the two kings
+  int n = 0, first_len = m.hasPawns ? 0 : m.hasUniquePieces ? 3 : 2;
+  l.groupLen[n] = 1;
+  for (int i = 1; i < m.pieceCount; ++i)
+    if (--first_len > 0 || l.pieces[i] == l.pieces[i - 1])
+      l.groupLen[n]++;
+    else
+      l.groupLen[++n] = 1;
+  l.groupLen[++n] = 0;
+
+  // Groups are weighted in the order given by the file, a group that can
+  // be placed in N(g) ways weighs the product of N over the later ones
+  const bool pp = m.hasPawns && m.pawnCount[1];
+  int next = pp ? 2 : 1;
+  int free_squares = 64 - l.groupLen[0] - (pp ? l.groupLen[1] : 0);
+  uint64_t idx = 1;
+  for (int k = 0; next < n || k == order[0] || k == order[1]; ++k) {
+    if (k == order[0]) {
+      l.groupIdx[0] = idx;
+      idx *= m.hasPawns ? static_cast<uint64_t>(t.lead_pawns_size[l.groupLen[0]][file])
+             : m.hasUniquePieces ? 31332
+                                 : 462;
+    } else if (k == order[1]) {
+      l.groupIdx[1] = idx;
+      idx *= t.binomial[l.groupLen[1]][48 - l.groupLen[0]];
+    } else {
+      l.groupIdx[next] = idx;
+      idx *= t.binomial[l.groupLen[next]][free_squares];
+      free_squares -= l.groupLen[next++];
+    }
+  }
+  l.groupIdx[n] = idx;
+  return idx;
+}
+
+void place(const Material& m, const Board& board, Placement& p) {
+  // The table is stored with its own colours, and symmetric tables only
+  // with white to move
+  const bool flip = m.key == m.key2 ? board.sideToMove == BLACK
+                                    : material_key(board) != m.key;
+  const int to_table = flip ? 0 : 56;  // our square -> Syzygy, mirrored
+
+  p.stm = (board.sideToMove == BLACK) != flip;
+  p.size = p.leadPawns = p.file = 0;
+
+  Bitboard lead = 0;
+  if (m.hasPawns) {
+    lead = board.pieces(flip ? Color(BLACK - m.leadColor) : m.leadColor, PAWN);
+    for (Bitboard b = lead; b;) {
+      p.squares[p.size] = Bitboards::pop_lsb(b) ^ to_table;
+      p.pieces[p.size++] = piece_code(m.leadColor, PAWN);
+    }
+    p.leadPawns = p.size;
+    std::swap(p.squares[0], *std::max_element(p.squares, p.squares + p.size, pawns_before));
+    p.file = std::min(file_of(p.squares[0]), 7 - file_of(p.squares[0]));
+  }
+
+  for (int c = WHITE; c <= BLACK; ++c)
+    for (int pt = PAWN; pt <= KING; ++pt)
+      for (Bitboard b = board.pieces(Color(c), Piece(pt)) & ~lead; b;) {
+        p.squares[p.size] = Bitboards::pop_lsb(b) ^ to_table;
+        p.pieces[p.size++] = piece_code(Color(c ^ flip), Piece(pt));
+      }
+}
+
+uint64_t encode(const Material& m, const Layout& l, Placement& p) {
+  const Tables& t = tables();
+  int* squares = p.squares;
+  const int size = p.size;
+
+  // Same piece sequence as the table
+  for (int i = p.leadPawns; i < size - 1; ++i)
+    for (int j = i + 1; j < size; ++j)
+      if (l.pieces[i] == p.pieces[j]) {
+        std::swap(p.pieces[i], p.pieces[j]);
+        std::swap(squares[i], squares[j]);
+        break;
+      }
+
+  // Leading piece on files A-D
+  if (file_of(squares[0]) > 3)
+    for (int i = 0; i < size; ++i) squares[i] ^= 7;
+
+  uint64_t idx = 0;
+  if (m.hasPawns) {
+    idx = static_cast<uint64_t>(t.lead_pawn_idx[p.leadPawns][squares[0]]);
+    std::stable_sort(squares + 1, squares + p.leadPawns, pawns_before);
+    for (int i = 1; i < p.leadPawns; ++i) idx += t.binomial[i][t.map_pawns[squares[i]]];
+  } else {
+    // Leading piece on ranks 1-4, then below the diagonal: the first
+    // piece of the leading group off the diagonal decides the flip
+    if (rank_of(squares[0]) > 3)
+      for (int i = 0; i < size; ++i) squares[i] ^= 56;
+
+    for (int i = 0; i < l.groupLen[0]; ++i) {
+      if (!off_diagonal(squares[i])) continue;
+      if (off_diagonal(squares[i]) > 0)
+        for (int j = i; j < size; ++j)
+          squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+      break;
+    }
+
+    if (m.hasUniquePieces) {
+      const int adjust1 = squares[1] > squares[0];
+      const int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+      int v;
+      if (off_diagonal(squares[0]))
+        v = (t.map_a1d1d4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 + squares[2] -
+            adjust2;
+      else if (off_diagonal(squares[1]))
+        v = (6 * 63 + rank_of(squares[0]) * 28 + t.map_b1h1h7[squares[1]]) * 62 +
+            squares[2] - adjust2;
+      else if (off_diagonal(squares[2]))
+        v = 6 * 63 * 62 + 4 * 28 * 62 + rank_of(squares[0]) * 7 * 28 +
+            (rank_of(squares[1]) - adjust1) * 28 + t.map_b1h1h7[squares[2]];
+      else
+        v = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + rank_of(squares[0]) * 7 * 6 +
+            (rank_of(squares[1]) - adjust1) * 6 + (rank_of(squares[2]) - adjust2);
+      idx = static_cast<uint64_t>(v);
+    } else {
+      idx = static_cast<uint64_t>(t.map_kk[t.map_a1d1d4[squares[0]]][squares[1]]);
+    }
+  }
+
+  // The other groups, each sorted, a square skipping the ones taken by
+  // earlier groups
+  idx *= l.groupIdx[0];
+  int* group = squares + l.groupLen[0];
+  bool remaining_pawns = m.hasPawns && m.pawnCount[1];
+  for (int next = 1; l.groupLen[next]; ++next) {
+    std::stable_sort(group, group + l.groupLen[next]);
+    uint64_t n = 0;
+    for (int i = 0; i < l.groupLen[next]; ++i) {
+      const auto adjust = std::count_if(squares, group, [&](int s) { return group[i] > s; });
+      n += t.binomial[i + 1][group[i] - adjust - 8 * remaining_pawns];
+    }
+    remaining_pawns = false;
+    idx += n * l.groupIdx[next];
+    group += l.groupLen[next];
+  }
+  return idx;
+}
+
+}  // namespace Syzygy
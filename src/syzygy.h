@@ -0,0 +1,100 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "board.h"
+#include "types.h"
+
+/**
+ * The parts of the Syzygy file format shared by the prober (tablebase.cpp)
+ * and the generator (tablebase_gen.cpp): material keys, the piece layout
+ * of a table and the index of a position inside it. Adapted from the
+ * probing code of Fathom and Stockfish.
+ *
+ * Squares in here are Syzygy squares, A1 = 0, which is our square ^ 56.
+ */
+namespace Syzygy {
+
+constexpr int MAX_PIECES = 7;
+
+constexpr uint8_t WDL_MAGIC[4] = {0x71, 0xE8, 0x23, 0x5D};
+constexpr uint8_t DTZ_MAGIC[4] = {0xD7, 0x66, 0x0C, 0xA5};
+
+// First byte of a file, after the magic
+enum FileFlag : uint8_t { SPLIT = 1, HAS_PAWNS = 2 };
+
+// First byte of every table in a file
+enum TableFlag : uint8_t {
+  STM = 1,  // DTZ: the side stored is black
+  MAPPED = 2,
+  WIN_PLIES = 4,
+  LOSS_PLIES = 8,
+  WIDE = 16,
+  SINGLE_VALUE = 128,
+};
+
+// Piece codes of the files: 1..6 white pawn..king, 9..14 black
+constexpr uint8_t piece_code(Color c, Piece pt) {
+  return static_cast<uint8_t>((c << 3) | (pt + 1));
+}
+
+// Material of a table, white being the side named first
+struct Material {
+  std::string name;  // "KRPvKR"
+  uint64_t key = 0;   // material_key() of the table as named
+  uint64_t key2 = 0;  // the same with the colours swapped
+  int counts[2][6] = {};  // per colour and piece, kings included
+  int pieceCount = 0;
+  int pawnCount[2] = {0, 0};  // leading colour first
+  Color leadColor = WHITE;    // the side with fewer pawns, if any
+  bool hasPawns = false;
+  bool hasUniquePieces = false;
+};
+
+// Piece counts packed in nibbles, kings left out
+uint64_t material_key(const Board& board, bool swap_colors = false);
+
+// False when name is not a table name
+bool parse_material(const std::string& name, Material& m);
+
+// Name of the table holding these pieces, stronger side first: "KQvKR"
+std::string table_name(const int counts[2][6]);
+
+// How the pieces of one table (side to move, pawn file) are encoded
+struct Layout {
+  uint8_t pieces[MAX_PIECES] = {};
+  int groupLen[MAX_PIECES + 1] = {};
+  uint64_t groupIdx[MAX_PIECES + 1] = {};
+};
+
+// Splits the pieces of l into groups and sets their weights. order[0] is
+// the slot of the leading group, order[1] the one of the remaining pawns
+// (0xF without). Returns the number of indices of the table.
+uint64_t set_groups(const Material& m, Layout& l, const int order[2], int file);
+
+// A position seen from the table: colours swapped when the table has
+// them the other way round
+struct Placement {
+  int stm = 0;
+  int file = 0;  // of the leading pawn, 0..3, always 0 without pawns
+  int size = 0;
+  int leadPawns = 0;
+  int squares[MAX_PIECES] = {};
+  uint8_t pieces[MAX_PIECES] = {};
+};
+
+void place(const Material& m, const Board& board, Placement& p);
+
+// Index of p in the table encoded by l. Reorders and mirrors p.
+uint64_t encode(const Material& m, const Layout& l, Placement& p);
+
+}  // namespace Syzygy
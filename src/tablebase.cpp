@@ -0,0 +1,650 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "tablebase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bitboard.h"
+#include "syzygy.h"
+#include "types.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Tablebases {
+
+namespace {
+
+using Syzygy::Material;
+
+enum ProbeState {
+  FAIL,
+  OK,
+  CHANGE_STM,         // the DTZ file only stores the other side to move
+  ZEROING_BEST_MOVE,  // the best move is a capture or a pawn move
+};
+
+// Files are little endian, except the compressed bit streams
+uint16_t le16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | p[1] << 8);
+}
+
+uint32_t le32(const uint8_t* p) {
+  return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+uint32_t be32(const uint8_t* p) {
+  return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | uint32_t(p[3]);
+}
+
+uint64_t be64(const uint8_t* p) {
+  return uint64_t(be32(p)) << 32 | be32(p + 4);
+}
+
+// A symbol of the pairing tree is either a value (right child 0xFFF) or
+// a pair of symbols, 12 bits each in 3 bytes
+constexpr size_t LEAF = 0xFFF;
+size_t left_of(const uint8_t* lr) { return size_t(lr[1] & 0xF) << 8 | lr[0]; }
+size_t right_of(const uint8_t* lr) { return size_t(lr[2]) << 4 | lr[1] >> 4; }
+
+// One compressed table: a side to move and, with pawns, a file of the
+// leading pawn. Values are Huffman coded symbols in blocks, a sparse
+// index points into the middle of every span of values.
+struct PairsData {
+  Syzygy::Layout layout;
+  uint64_t size = 0;  // number of indices
+  uint8_t flags = 0;
+  uint8_t max_sym_len = 0;
+  uint8_t min_sym_len = 0;  // or the value of a SINGLE_VALUE table
+  uint32_t num_blocks = 0;
+  size_t block_size = 0;
+  size_t span = 0;
+  size_t sparse_index_size = 0;
+  size_t block_length_size = 0;
+  const uint8_t* lowest_sym = nullptr;    // u16 per code length
+  const uint8_t* btree = nullptr;         // 3 bytes per symbol
+  const uint8_t* sparse_index = nullptr;  // u32 block, u16 offset
+  const uint8_t* block_length = nullptr;  // u16 values - 1 per block
+  const uint8_t* data = nullptr;
+  std::vector<uint64_t> base64;  // first code of every length, left aligned
+  std::vector<uint8_t> symlen;   // values - 1 of every symbol
+  uint16_t map_idx[4] = {};      // DTZ: where the value maps start
+};
+
+struct TableFile {
+  std::atomic<bool> ready{false};
+  bool failed = false;  // not there or corrupt, not retried
+
+  const uint8_t* base = nullptr;
+  size_t bytes = 0;
+  void* mapping = nullptr;     // mmap base
+  std::vector<uint8_t> owned;  // or read into memory
+
+  const uint8_t* map = nullptr;  // DTZ value maps
+  PairsData items[2][4];         // [side to move][file]
+
+  TableFile() = default;
+  TableFile(const TableFile&) = delete;
+  TableFile& operator=(const TableFile&) = delete;
+
+  ~TableFile() {
+#ifdef __linux__
+    if (mapping) munmap(mapping, bytes);
+#endif
+  }
+};
+
+struct Entry {
+  Material material;
+  std::string path;  // without extension
+  TableFile wdl, dtz;
+};
+
+std::vector<std::unique_ptr<Entry>> entries;
+std::unordered_map<uint64_t, Entry*> by_key;  // both colourings
+std::mutex mapping_mutex;
+int largest = 0;
+
+// Bounds checked reader over a mapped file
+struct Cursor {
+  const uint8_t* base;
+  size_t size;
+  size_t pos = 0;
+  bool ok = true;
+
+  const uint8_t* take(size_t n) {
+    if (pos > size || n > size - pos) {
+      ok = false;
+      pos = size;
+      return base;
+    }
+    const uint8_t* p = base + pos;
+    pos += n;
+    return p;
+  }
+  uint8_t byte() { return *take(1); }
+  void align(size_t a) {
+    pos = (pos + a - 1) / a * a;
+    if (pos > size) ok = false;
+  }
+};
+
+bool set_symlen(PairsData& d, size_t s, std::vector<bool>& visited) {
+  visited[s] = true;  // the tree is acyclic
+  const uint8_t* lr = d.btree + 3 * s;
+  const size_t right = right_of(lr);
+  if (right == LEAF) return true;
+  const size_t left = left_of(lr);
+  if (left >= d.symlen.size() || right >= d.symlen.size()) return false;
+  if (!visited[left] && !set_symlen(d, left, visited)) return false;
+  if (!visited[right] && !set_symlen(d, right, visited)) return false;
+  d.symlen[s] = static_cast<uint8_t>(d.symlen[left] + d.symlen[right] + 1);
+  return true;
+}
+
+bool set_sizes(PairsData& d, Cursor& in) {
+  d.flags = in.byte();
+  if (d.flags & Syzygy::SINGLE_VALUE) {
+    d.min_sym_len = in.byte();
+    return in.ok;
+  }
+
+  const uint8_t block_bits = in.byte(), span_bits = in.byte();
+  if (block_bits > 24 || span_bits > 24) return false;
+  d.block_size = size_t(1) << block_bits;
+  d.span = size_t(1) << span_bits;
+  d.sparse_index_size = static_cast<size_t>((d.size + d.span - 1) / d.span);
+  const uint8_t padding = in.byte();  // the sparse index may point past the last block
+  d.num_blocks = le32(in.take(4));
+  d.block_length_size = size_t(d.num_blocks) + padding;
+  d.max_sym_len = in.byte();
+  d.min_sym_len = in.byte();
+  if (d.min_sym_len == 0 || d.max_sym_len < d.min_sym_len || d.max_sym_len > 32) return false;
+
+  const size_t lengths = size_t(d.max_sym_len - d.min_sym_len) + 1;
+  d.lowest_sym = in.take(2 * lengths);
+  if (!in.ok) return false;
+
+  // Longer codes have lower values, the first code of every length
+  // follows from the number of symbols of the longer ones
+  d.base64.assign(lengths, 0);
+  for (size_t i = lengths - 1; i-- > 0;)
+    d.base64[i] = (d.base64[i + 1] + le16(d.lowest_sym + 2 * i) -
+                   le16(d.lowest_sym + 2 * (i + 1))) / 2;
+  for (size_t i = 0; i < lengths; ++i) d.base64[i] <<= 64 - i - d.min_sym_len;
+
+  const size_t symbols = le16(in.take(2));
+  d.btree = in.take(3 * symbols);
+  in.take(symbols & 1);
+  if (!in.ok) return false;
+
+  d.symlen.assign(symbols, 0);
+  std::vector<bool> visited(symbols);
+  for (size_t s = 0; s < symbols; ++s)
+    if (!visited[s] && !set_symlen(d, s, visited)) return false;
+  return true;
+}
+
+// Value number idx of the table
+int decompress(const PairsData& d, uint64_t idx) {
+  if (d.flags & Syzygy::SINGLE_VALUE) return d.min_sym_len;
+
+  const uint8_t* sparse = d.sparse_index + 6 * static_cast<size_t>(idx / d.span);
+  uint32_t block = le32(sparse);
+  int offset = le16(sparse + 4) + static_cast<int>(idx % d.span) - static_cast<int>(d.span / 2);
+  while (offset < 0) offset += le16(d.block_length + 2 * size_t(--block)) + 1;
+  while (offset > le16(d.block_length + 2 * size_t(block)))
+    offset -= le16(d.block_length + 2 * size_t(block++)) + 1;
+
+  // Walk the symbols of the block up to the one holding the value
+  const uint8_t* ptr = d.data + size_t(block) * d.block_size;
+  uint64_t buf64 = be64(ptr);
+  ptr += 8;
+  int buf64_size = 64;
+  size_t sym;
+  for (;;) {
+    size_t len = 0;
+    while (buf64 < d.base64[len]) ++len;
+    sym = static_cast<size_t>((buf64 - d.base64[len]) >> (64 - len - d.min_sym_len)) +
+          le16(d.lowest_sym + 2 * len);
+    if (offset < d.symlen[sym] + 1) break;
+    offset -= d.symlen[sym] + 1;
+    len += d.min_sym_len;
+    buf64 <<= len;
+    buf64_size -= static_cast<int>(len);
+    if (buf64_size <= 32) {
+      buf64_size += 32;
+      buf64 |= uint64_t(be32(ptr)) << (64 - buf64_size);
+      ptr += 4;
+    }
+  }
+
+  // Then down the pairing tree
+  while (d.symlen[sym]) {
+    const uint8_t* lr = d.btree + 3 * sym;
+    const size_t left = left_of(lr);
+    if (offset < d.symlen[left] + 1) {
+      sym = left;
+    } else {
+      offset -= d.symlen[left] + 1;
+      sym = right_of(lr);
+    }
+  }
+  return static_cast<int>(left_of(d.btree + 3 * sym));
+}
+
+// Parses the headers of a mapped file
+bool setup(TableFile& f, const Material& m, bool dtz) {
+  Cursor in{f.base, f.bytes};
+  in.take(4);  // magic
+  const uint8_t flags = in.byte();
+  if (bool(flags & Syzygy::HAS_PAWNS) != m.hasPawns ||
+      bool(flags & Syzygy::SPLIT) != (m.key != m.key2))
+    return false;
+
+  const int sides = !dtz && m.key != m.key2 ? 2 : 1;
+  const int files = m.hasPawns ? 4 : 1;
+  const bool pp = m.hasPawns && m.pawnCount[1];
+
+  for (int file = 0; file < files; ++file) {
+    const uint8_t o = in.byte();
+    const uint8_t o2 = pp ? in.byte() : 0;
+    const int order[2][2] = {{o & 0xF, pp ? o2 & 0xF : 0xF}, {o >> 4, pp ? o2 >> 4 : 0xF}};
+    for (int k = 0; k < m.pieceCount; ++k) {
+      const uint8_t pieces = in.byte();
+      for (int i = 0; i < sides; ++i)
+        f.items[i][file].layout.pieces[k] = static_cast<uint8_t>(i ? pieces >> 4 : pieces & 0xF);
+    }
+    for (int i = 0; i < sides; ++i)
+      f.items[i][file].size = Syzygy::set_groups(m, f.items[i][file].layout, order[i], file);
+  }
+  in.align(2);
+
+  for (int file = 0; file < files; ++file)
+    for (int i = 0; i < sides; ++i)
+      if (!set_sizes(f.items[i][file], in)) return false;
+
+  if (dtz) {
+    const size_t map_pos = in.pos;
+    f.map = f.base + map_pos;
+    for (int file = 0; file < files; ++file) {
+      PairsData& d = f.items[0][file];
+      if (!(d.flags & Syzygy::MAPPED)) continue;
+      if (d.flags & Syzygy::WIDE) {
+        in.align(2);
+        for (int i = 0; i < 4; ++i) {
+          d.map_idx[i] = static_cast<uint16_t>((in.pos - map_pos) / 2 + 1);
+          in.take(2 * size_t(le16(in.take(2))));
+        }
+      } else {
+        for (int i = 0; i < 4; ++i) {
+          d.map_idx[i] = static_cast<uint16_t>(in.pos - map_pos + 1);
+          in.take(in.byte());
+        }
+      }
+    }
+    in.align(2);
+  }
+
+  for (int file = 0; file < files; ++file)
+    for (int i = 0; i < sides; ++i) {
+      PairsData& d = f.items[i][file];
+      d.sparse_index = in.take(6 * d.sparse_index_size);
+    }
+  for (int file = 0; file < files; ++file)
+    for (int i = 0; i < sides; ++i) {
+      PairsData& d = f.items[i][file];
+      d.block_length = in.take(2 * d.block_length_size);
+    }
+  for (int file = 0; file < files; ++file)
+    for (int i = 0; i < sides; ++i) {
+      PairsData& d = f.items[i][file];
+      in.align(64);
+      d.data = in.take(size_t(d.num_blocks) * d.block_size);
+    }
+  return in.ok;
+}
+
+bool map_file(TableFile& f, const std::string& file, const uint8_t magic[4]) {
+#ifdef __linux__
+  const int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  // Data is padded to 64 bytes and followed by a 16 byte checksum
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size % 64 != 16) {
+    close(fd);
+    return false;
+  }
+  const size_t bytes = static_cast<size_t>(st.st_size);
+  void* mem = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED) return false;
+  madvise(mem, bytes, MADV_RANDOM);
+
+  f.mapping = mem;
+  f.base = static_cast<const uint8_t*>(mem);
+  f.bytes = bytes;
+#else
+  std::ifstream in(file, std::ios::binary);
+  f.owned.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  if (f.owned.size() % 64 != 16) return false;
+  f.base = f.owned.data();
+  f.bytes = f.owned.size();
+#endif
+  return std::equal(magic, magic + 4, f.base);
+}
+
+// The file of the entry, mapped on first use
+const TableFile* table(Entry& e, bool dtz) {
+  TableFile& f = dtz ? e.dtz : e.wdl;
+  if (f.ready.load(std::memory_order_acquire)) return &f;
+
+  std::lock_guard<std::mutex> lock(mapping_mutex);
+  if (f.ready.load(std::memory_order_relaxed)) return &f;
+  if (f.failed) return nullptr;
+
+  const std::string file = e.path + (dtz ? ".rtbz" : ".rtbw");
+  if (!map_file(f, file, dtz ? Syzygy::DTZ_MAGIC : Syzygy::WDL_MAGIC) ||
+      !setup(f, e.material, dtz)) {
+    f.failed = true;
+    return nullptr;
+  }
+  f.ready.store(true, std::memory_order_release);
+  return &f;
+}
+
+// DTZ files store moves or plies, mapped or not, depending on the table
+int map_score(const TableFile& f, const PairsData& d, int value, WDL wdl) {
+  constexpr int WDL_MAP[] = {1, 3, 0, 2, 0};
+  if (d.flags & Syzygy::MAPPED) {
+    const size_t i = size_t(d.map_idx[WDL_MAP[wdl + 2]]) + static_cast<size_t>(value);
+    value = d.flags & Syzygy::WIDE ? le16(f.map + 2 * i) : f.map[i];
+  }
+  if ((wdl == WDL_WIN && !(d.flags & Syzygy::WIN_PLIES)) ||
+      (wdl == WDL_LOSS && !(d.flags & Syzygy::LOSS_PLIES)) || wdl == WDL_CURSED_WIN ||
+      wdl == WDL_BLESSED_LOSS)
+    value *= 2;
+  return value + 1;
+}
+
+// The stored value of the position, en passant and captures ignored. For
+// DTZ, wdl is the result of the position.
+int probe_table(const Board& board, bool dtz, WDL wdl, ProbeState& state) {
+  if (Bitboards::popcount(board.allPieces()) == 2) return 0;  // KvK
+
+  const auto it = by_key.find(Syzygy::material_key(board));
+  const TableFile* f = it == by_key.end() ? nullptr : table(*it->second, dtz);
+  if (!f) {
+    state = FAIL;
+    return 0;
+  }
+
+  const Material& m = it->second->material;
+  Syzygy::Placement p;
+  Syzygy::place(m, board, p);
+  if (dtz && (f->items[0][p.file].flags & Syzygy::STM) != p.stm &&
+      !(m.key == m.key2 && !m.hasPawns)) {
+    state = CHANGE_STM;
+    return 0;
+  }
+
+  const PairsData& d = f->items[dtz ? 0 : p.stm][p.file];
+  const uint64_t idx = Syzygy::encode(m, d.layout, p);
+  if (idx >= d.size) {
+    state = FAIL;
+    return 0;
+  }
+  const int value = decompress(d, idx);
+  return dtz ? map_score(*f, d, value, wdl) : value - 2;
+}
+
+bool is_capture(const Board& board, Move m) {
+  return m.type() == EN_PASSANT ||
+         (board.occupancy[BLACK - board.sideToMove] & Bitboards::square_bb(m.to_sq()));
+}
+
+bool is_pawn_move(const Board& board, Move m) {
+  return board.pieces(board.sideToMove, PAWN) & Bitboards::square_bb(m.from_sq());
+}
+
+bool is_mate(const Board& board) {
+  std::array<Move, MAX_MOVES> moves;
+  return board.checkers && MoveGen::generate_all(board, moves) == 0;
+}
+
+int sign(int v) { return (v > 0) - (v < 0); }
+
+// The tables hold no en passant rights and may store anything where a
+// capture is best, so captures (and with CHECK_ZEROING pawn moves too)
+// are searched before the table is trusted
+template <bool CHECK_ZEROING>
+WDL search(const Board& board, ProbeState& state) {
+  int best = WDL_LOSS;
+  std::array<Move, MAX_MOVES> moves;
+  const size_t total = MoveGen::generate_all(board, moves);
+  size_t searched = 0;
+
+  for (size_t i = 0; i < total; ++i) {
+    const Move m = moves[i];
+    if (!is_capture(board, m) && (!CHECK_ZEROING || !is_pawn_move(board, m))) continue;
+
+    ++searched;
+    Board child = board;
+    child.makeMove(m);
+    const int value = -search<false>(child, state);
+    if (state == FAIL) return WDL_DRAW;
+    if (value > best) {
+      best = value;
+      if (value >= WDL_WIN) {
+        state = ZEROING_BEST_MOVE;
+        return WDL(value);
+      }
+    }
+  }
+
+  // With every move searched the stored value is not needed, and might
+  // be wrong (en passant)
+  const bool no_more_moves = searched && searched == total;
+  int value = best;
+  if (!no_more_moves) {
+    value = probe_table(board, false, WDL_DRAW, state);
+    if (state == FAIL) return WDL_DRAW;
+  }
+
+  if (best >= value) {
+    state = best > WDL_DRAW || no_more_moves ? ZEROING_BEST_MOVE : OK;
+    return WDL(best);
+  }
+  state = OK;
+  return WDL(value);
+}
+
+// DTZ of the move before a capture or pawn move with this result
+int dtz_before_zeroing(WDL wdl) {
+  switch (wdl) {
+    case WDL_WIN: return 1;
+    case WDL_CURSED_WIN: return 101;
+    case WDL_BLESSED_LOSS: return -101;
+    case WDL_LOSS: return -1;
+    default: return 0;
+  }
+}
+
+int dtz(const Board& board, ProbeState& state) {
+  state = OK;
+  const WDL wdl = search<true>(board, state);
+  if (state == FAIL || wdl == WDL_DRAW) return 0;  // draws are not stored
+  if (state == ZEROING_BEST_MOVE) return dtz_before_zeroing(wdl);
+
+  int value = probe_table(board, true, wdl, state);
+  if (state == FAIL) return 0;
+  if (state != CHANGE_STM)
+    return (value + 100 * (wdl == WDL_BLESSED_LOSS || wdl == WDL_CURSED_WIN)) * sign(wdl);
+
+  // Stored for the other side only: one ply deeper, best of the moves
+  // that keep the result
+  int min_dtz = 0xFFFF;
+  std::array<Move, MAX_MOVES> moves;
+  const size_t n = MoveGen::generate_all(board, moves);
+  for (size_t i = 0; i < n; ++i) {
+    const bool zeroing = is_capture(board, moves[i]) || is_pawn_move(board, moves[i]);
+    Board child = board;
+    child.makeMove(moves[i]);
+
+    // A zeroing move is worth the DTZ before it, not after
+    value = zeroing ? -dtz_before_zeroing(search<false>(child, state)) : -dtz(child, state);
+    if (value == 1 && is_mate(child)) min_dtz = 1;
+    if (!zeroing) value += sign(value);
+    if (value < min_dtz && sign(value) == sign(wdl)) min_dtz = value;
+    if (state == FAIL) return 0;
+  }
+  return min_dtz == 0xFFFF ? -1 : min_dtz;  // no moves: mated
+}
+
+constexpr int MAX_DTZ = 1 << 18;
+
+// Unlike Stockfish certain wins are ranked by DTZ too: without repetition
+// detection the shortest way to the next zeroing move is what keeps the
+// engine making progress
+bool rank_by_dtz(const Board& board, const std::array<Move, MAX_MOVES>& moves, size_t n,
+                 std::array<int, MAX_MOVES>& rank) {
+  const int cnt50 = board.halfMoveClock;
+  ProbeState state = OK;
+  for (size_t i = 0; i < n; ++i) {
+    const bool zeroing = is_capture(board, moves[i]) || is_pawn_move(board, moves[i]);
+    Board child = board;
+    child.makeMove(moves[i]);
+
+    int value;
+    if (zeroing) {
+      state = OK;
+      value = dtz_before_zeroing(WDL(-search<false>(child, state)));
+    } else {
+      value = -dtz(child, state);
+      value += sign(value);
+    }
+    if (value == 2 && is_mate(child)) value = 1;
+    if (state == FAIL) return false;
+
+    // Wins the 50-move rule cannot spoil first, then the others; losses
+    // the other way round
+    if (value > 0)
+      rank[i] = value + cnt50 <= 99 ? MAX_DTZ - value : MAX_DTZ - 100 - (value + cnt50);
+    else if (value < 0)
+      rank[i] = -value * 2 + cnt50 < 100 ? -MAX_DTZ - value : -MAX_DTZ + 100 + (-value + cnt50);
+    else
+      rank[i] = 0;
+  }
+  return true;
+}
+
+bool rank_by_wdl(const Board& board, const std::array<Move, MAX_MOVES>& moves, size_t n,
+                 std::array<int, MAX_MOVES>& rank) {
+  constexpr int WDL_TO_RANK[] = {-MAX_DTZ, -MAX_DTZ + 101, 0, MAX_DTZ - 101, MAX_DTZ};
+  ProbeState state = OK;
+  for (size_t i = 0; i < n; ++i) {
+    Board child = board;
+    child.makeMove(moves[i]);
+    const WDL wdl = search<false>(child, state);
+    if (state == FAIL) return false;
+    rank[i] = WDL_TO_RANK[-wdl + 2];
+  }
+  return true;
+}
+
+bool covered(const Board& board) {
+  return board.castling == NO_CASTLING &&
+         Bitboards::popcount(board.allPieces()) <= largest;
+}
+
+}  // namespace
+
+size_t init(const std::string& path) {
+  by_key.clear();
+  entries.clear();
+  largest = 0;
+
+  std::stringstream ss(path);
+  std::string dir;
+  std::error_code ec;
+  while (std::getline(ss, dir, ':')) {
+    if (dir.empty()) continue;
+    for (const auto& file : std::filesystem::directory_iterator(dir, ec)) {
+      if (file.path().extension() != ".rtbw") continue;
+
+      auto e = std::make_unique<Entry>();
+      if (!Syzygy::parse_material(file.path().stem().string(), e->material) ||
+          by_key.count(e->material.key))
+        continue;
+      e->path = (file.path().parent_path() / file.path().stem()).string();
+      by_key[e->material.key] = e.get();
+      by_key[e->material.key2] = e.get();
+      largest = std::max(largest, e->material.pieceCount);
+      entries.push_back(std::move(e));
+    }
+  }
+  return entries.size();
+}
+
+int max_pieces() {
+  return largest;
+}
+
+bool probe_wdl(const Board& board, WDL& wdl) {
+  if (!covered(board)) return false;
+  ProbeState state = OK;
+  wdl = search<false>(board, state);
+  return state != FAIL;
+}
+
+bool probe_dtz(const Board& board, int& value) {
+  if (!covered(board)) return false;
+  ProbeState state = OK;
+  value = dtz(board, state);
+  return state != FAIL;
+}
+
+size_t filter_root_moves(const Board& board, std::array<Move, MAX_MOVES>& moves,
+                         size_t n) {
+  if (n == 0 || !covered(board)) return n;
+
+  std::array<int, MAX_MOVES> rank;
+  if (!rank_by_dtz(board, moves, n, rank) && !rank_by_wdl(board, moves, n, rank))
+    return n;
+
+  const int best = *std::max_element(rank.begin(), rank.begin() + static_cast<std::ptrdiff_t>(n));
+  size_t kept = 0;
+  for (size_t i = 0; i < n; ++i)
+    if (rank[i] == best) moves[kept++] = moves[i];
+  return kept;
+}
+
+std::string signature(const Board& board) {
+  int counts[2][6] = {};
+  for (int c = WHITE; c <= BLACK; ++c)
+    for (int pt = PAWN; pt <= KING; ++pt)
+      counts[c][pt] = Bitboards::popcount(board.pieces(Color(c), Piece(pt)));
+  return Syzygy::table_name(counts);
+}
+
+}  // namespace Tablebases
@@ -0,0 +1,67 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "board.h"
+#include "move.h"
+#include "movegen.h"
+
+/**
+ * Syzygy endgame tables: .rtbw files hold win/draw/loss, .rtbz files the
+ * distance to zeroing (plies to the next capture or pawn move with best
+ * play). The prober is adapted from Fathom and Stockfish, files are
+ * memory-mapped the first time a position needs them.
+ *
+ * Results take the 50-move rule into account: a cursed win needs more
+ * than 50 moves without a capture or pawn move, a blessed loss is its
+ * counterpart, both are draws over the board. Positions with castling
+ * rights are never probed.
+ *
+ * tools/tablebase_gen.h builds small tables in the same format.
+ */
+namespace Tablebases {
+
+enum WDL : int8_t {
+  WDL_LOSS = -2,
+  WDL_BLESSED_LOSS = -1,
+  WDL_DRAW = 0,
+  WDL_CURSED_WIN = 1,
+  WDL_WIN = 2,
+};
+
+// Looks for .rtbw/.rtbz pairs in path (':' separated directories),
+// replacing the tables found before. Returns the number of .rtbw files.
+size_t init(const std::string& path);
+
+// Largest number of pieces (kings included) of any table found
+int max_pieces();
+
+// Result for the side to move, false if no table covers this position
+bool probe_wdl(const Board& board, WDL& wdl);
+
+// Plies to zeroing for the side to move: positive when winning, negative
+// when losing, 0 for draws. Beyond 100 for cursed wins and blessed
+// losses. Tables that store moves instead of plies can be one ply off.
+bool probe_dtz(const Board& board, int& dtz);
+
+// Keeps the root moves that preserve the table result with the halfmove
+// clock of board, and among those only the fastest wins (or slowest
+// losses). Ranks by DTZ, or by WDL alone when a .rtbz file is missing.
+// Returns the new move count, n when the root is not covered.
+size_t filter_root_moves(const Board& board, std::array<Move, MAX_MOVES>& moves,
+                         size_t n);
+
+// Table name of the board, stronger side first: "KQvKR"
+std::string signature(const Board& board);
+
+}  // namespace Tablebases
@@ -0,0 +1,96 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "thread.h"
+
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(size_t n) {
+  start_workers(n);
+}
+
+ThreadPool::~ThreadPool() {
+  wait();
+  stop_workers();
+}
+
+void ThreadPool::resize(size_t n) {
+  n = std::max<size_t>(1, n);
+  wait();
+  if (n == workers.size()) return;
+  stop_workers();
+  start_workers(n);
+}
+
+void ThreadPool::start_workers(size_t n) {
+  quit = false;
+  workers.reserve(n);
+  for (size_t i = 0; i < std::max<size_t>(1, n); ++i)
+    workers.emplace_back(&ThreadPool::worker_loop, this, i, generation);
+}
+
+void ThreadPool::stop_workers() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    quit = true;
+  }
+  work_cv.notify_all();
+  for (auto& t : workers) t.join();
+  workers.clear();
+}
+
+void ThreadPool::run(Job new_job) {
+  std::unique_lock<std::mutex> lock(mtx);
+  idle_cv.wait(lock, [this] { return running == 0; });
+  job = std::move(new_job);
+  running = workers.size();
+  ++generation;
+  lock.unlock();
+  work_cv.notify_all();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(mtx);
+  idle_cv.wait(lock, [this] { return running == 0; });
+}
+
+bool ThreadPool::busy() {
+  std::lock_guard<std::mutex> lock(mtx);
+  return running != 0;
+}
+
+void ThreadPool::parallel_for(size_t count,
+                              const std::function<void(size_t)>& fn) {
+  std::atomic<size_t> next{0};
+  run([&](size_t) {
+    for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+         i = next.fetch_add(1, std::memory_order_relaxed))
+      fn(i);
+  });
+  wait();
+}
+
+// seen starts at the generation the pool had when the worker was created,
+// so a worker added by resize() does not replay the previous job
+void ThreadPool::worker_loop(size_t idx, uint64_t seen) {
+  std::unique_lock<std::mutex> lock(mtx);
+
+  while (true) {
+    work_cv.wait(lock, [&] { return quit || generation != seen; });
+    if (quit) return;
+
+    seen = generation;
+    Job current = job;
+    lock.unlock();
+
+    current(idx);
+
+    lock.lock();
+    if (--running == 0) idle_cv.notify_all();
+  }
+}
@@ -0,0 +1,60 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads parked on a condition variable between jobs.
+ * A job is a function of the worker index that every worker runs once;
+ * run() hands it out without blocking and wait() returns only when all
+ * workers are parked again, so two jobs can never overlap.
+ */
+class ThreadPool {
+ public:
+  using Job = std::function<void(size_t)>;
+
+  explicit ThreadPool(size_t n = 1);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Waits for the current job, then replaces the workers
+  void resize(size_t n);
+  size_t size() const { return workers.size(); }
+
+  void run(Job job);
+  void wait();
+  bool busy();
+
+  // Calls fn(i) for every i in [0, count), spread over all workers, and
+  // blocks until it is done. Indices are handed out one by one, so uneven
+  // work still balances.
+  void parallel_for(size_t count, const std::function<void(size_t)>& fn);
+
+ private:
+  void start_workers(size_t n);
+  void stop_workers();
+  void worker_loop(size_t idx, uint64_t seen);
+
+  std::vector<std::thread> workers;
+  std::mutex mtx;
+  std::condition_variable work_cv;
+  std::condition_variable idle_cv;
+  Job job;
+  uint64_t generation = 0;
+  size_t running = 0;
+  bool quit = false;
+};
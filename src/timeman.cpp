@@ -0,0 +1,133 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "timeman.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "search.h"
+
+namespace FoChess {
+
+namespace {
+
+constexpr int DEFAULT_MOVES_TO_GO = 25;
+constexpr int MAX_MOVES_TO_GO = 50;
+
+}  // namespace
+
+void TimeManager::init(const TimeControl& tc, int64_t move_overhead) {
+  soft_ms = hard_ms = 0;
+  adaptive = false;
+  soft_scale = 1.0;
+  last_best = Move();
+  stable_iterations = 0;
+  last_score = 0;
+  origin_ms.store(0, std::memory_order_relaxed);
+
+  if (tc.infinite) return;
+
+  if (tc.movetime > 0) {
+    soft_ms = hard_ms = std::max<int64_t>(1, tc.movetime - move_overhead);
+    return;
+  }
+
+  if (tc.time <= 0) return;
+
+  // Keep the overhead for every move we still have to play in this period
+  const int mtg = tc.movestogo > 0
+                      ? std::min(tc.movestogo, MAX_MOVES_TO_GO)
+                      : DEFAULT_MOVES_TO_GO;
+  const int64_t remaining =
+      std::max<int64_t>(1, tc.time - move_overhead * std::min(mtg, 5));
+
+  // With one move left we may use (almost) all of it
+  const int64_t max_use = mtg == 1 ? remaining * 9 / 10 : remaining * 4 / 10;
+
+  soft_ms = std::min(remaining / mtg + tc.inc * 3 / 4, max_use);
+  hard_ms = std::min(soft_ms * 4, max_use);
+
+  soft_ms = std::max<int64_t>(1, soft_ms);
+  hard_ms = std::max(soft_ms, hard_ms);
+  adaptive = mtg > 1;
+}
+
+void TimeManager::on_iteration(int depth, Move best_move, int score) {
+  if (!adaptive) return;
+
+  stable_iterations = (best_move == last_best) ? stable_iterations + 1 : 0;
+
+  // 1.4 right after the best move changed, down to 0.6 once it has held
+  // for a few iterations
+  double stability = std::max(0.6, 1.4 - 0.16 * stable_iterations);
+
+  // Up to twice the time when the score dropped since the last iteration
+  double drop = 1.0;
+  if (depth > 1 && !is_mate_score(score) && !is_mate_score(last_score) &&
+      score < last_score)
+    drop += std::min(last_score - score, 150) / 150.0;
+
+  soft_scale = std::clamp(stability * drop, 0.5, 2.5);
+  last_best = best_move;
+  last_score = score;
+}
+
+bool TimeManager::stop_iterating(int64_t elapsed_ms) const {
+  if (!enabled()) return false;
+
+  auto used = elapsed_ms - origin_ms.load(std::memory_order_relaxed);
+  auto limit = std::min(
+      static_cast<int64_t>(static_cast<double>(soft_ms) * soft_scale), hard_ms);
+  return used >= limit;
+}
+
+Watchdog::~Watchdog() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    quit = true;
+  }
+  cv.notify_one();
+  if (worker.joinable()) worker.join();
+}
+
+void Watchdog::arm(Clock::time_point new_deadline) {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    deadline = new_deadline;
+    armed = true;
+    if (!worker.joinable()) worker = std::thread(&Watchdog::run, this);
+  }
+  cv.notify_one();
+}
+
+void Watchdog::disarm() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    armed = false;
+  }
+  cv.notify_one();
+}
+
+void Watchdog::run() {
+  std::unique_lock<std::mutex> lock(mtx);
+  while (!quit) {
+    if (!armed) {
+      cv.wait(lock);
+      continue;
+    }
+
+    // Woken early when the deadline moved or got disarmed
+    if (cv.wait_until(lock, deadline) == std::cv_status::timeout && armed &&
+        Clock::now() >= deadline) {
+      stop_flag.store(true, std::memory_order_relaxed);
+      armed = false;
+    }
+  }
+}
+
+}  // namespace FoChess
@@ -0,0 +1,108 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "move.h"
+
+namespace FoChess {
+
+// What "go" told us about the clock, all times in milliseconds
+struct TimeControl {
+  int64_t time = 0;
+  int64_t inc = 0;
+  int movestogo = 0;
+  int64_t movetime = 0;
+  bool infinite = false;
+};
+
+/**
+ * Splits the clock into a soft limit (do not start another iteration) and
+ * a hard limit (abort the running one). The soft limit is scaled after
+ * each iteration: a best move that keeps changing or a score that drops
+ * buys more time, a stable best move gives some back.
+ *
+ * Limits are relative to origin_ms, the elapsed search time at which our
+ * clock started: 0 for a normal search, the ponderhit time when pondering.
+ */
+class TimeManager {
+ public:
+  void init(const TimeControl& tc, int64_t move_overhead);
+
+  // Called by the search thread after every completed iteration
+  void on_iteration(int depth, Move best_move, int score);
+
+  bool stop_iterating(int64_t elapsed_ms) const;
+
+  void start(int64_t origin) {
+    origin_ms.store(origin, std::memory_order_relaxed);
+  }
+
+  bool enabled() const { return hard_ms > 0; }
+
+  // Absolute hard deadline in search time, 0 when there is none
+  int64_t hard_deadline() const {
+    return enabled() ? origin_ms.load(std::memory_order_relaxed) + hard_ms : 0;
+  }
+
+  int64_t soft_limit() const { return soft_ms; }
+  int64_t hard_limit() const { return hard_ms; }
+  double scale() const { return soft_scale; }
+
+ private:
+  int64_t soft_ms = 0;
+  int64_t hard_ms = 0;
+  bool adaptive = false;  // false for movetime, which is a fixed budget
+  std::atomic<int64_t> origin_ms{0};
+
+  double soft_scale = 1.0;
+  Move last_best;
+  int stable_iterations = 0;
+  int last_score = 0;
+};
+
+/**
+ * Timer thread that raises a stop flag at a deadline. The search threads
+ * then only need a relaxed load of the flag per node instead of reading
+ * the clock, and stop latency no longer depends on the node rate. The
+ * thread is started on the first arm() and sleeps while disarmed.
+ */
+class Watchdog {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit Watchdog(std::atomic<bool>& flag) : stop_flag(flag) {}
+  ~Watchdog();
+
+  Watchdog(const Watchdog&) = delete;
+  Watchdog& operator=(const Watchdog&) = delete;
+
+  // A new deadline replaces the previous one
+  void arm(Clock::time_point deadline);
+  // After this returns the flag will not be raised for the old deadline
+  void disarm();
+
+ private:
+  void run();
+
+  std::atomic<bool>& stop_flag;
+  std::mutex mtx;
+  std::condition_variable cv;
+  Clock::time_point deadline;
+  bool armed = false;
+  bool quit = false;
+  std::thread worker;
+};
+
+}  // namespace FoChess
@@ -0,0 +1,307 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "tt.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "thread.h"
+#include "zobrist.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+// Saved table layout: a TTFileHeader padded to TT_FILE_DATA_OFFSET, then
+// the raw entries, so the data can be mapped page aligned. A file is only
+// accepted if the version, the entry layout and the Zobrist keys match.
+constexpr char TT_FILE_MAGIC[8] = {'F', 'O', 'C', 'H', 'E', 'S', 'S', 'T'};
+constexpr uint32_t TT_FILE_VERSION = 2;
+constexpr size_t TT_FILE_DATA_OFFSET = 4096;
+
+struct TTFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t entry_size;
+  uint64_t entries;
+  uint8_t field_offsets[6];  // hash_key, score, best_move, eval, depth, flag
+  uint8_t reserved[2];
+  uint64_t zobrist_check;
+};
+
+TTFileHeader make_header(size_t entries) {
+  TTFileHeader h{};
+  std::copy(TT_FILE_MAGIC, TT_FILE_MAGIC + 8, h.magic);
+  h.version = TT_FILE_VERSION;
+  h.entry_size = sizeof(TTEntry);
+  h.entries = entries;
+  h.field_offsets[0] = offsetof(TTEntry, hash_key);
+  h.field_offsets[1] = offsetof(TTEntry, score);
+  h.field_offsets[2] = offsetof(TTEntry, best_move);
+  h.field_offsets[3] = offsetof(TTEntry, eval);
+  h.field_offsets[4] = offsetof(TTEntry, depth);
+  h.field_offsets[5] = offsetof(TTEntry, flag);
+  // Different keys would make every stored hash meaningless
+  h.zobrist_check = Zobrist::pieces_keys[0] ^ Zobrist::pieces_keys[767] ^
+                    Zobrist::castling_keys[15] ^ Zobrist::sideToMove_key;
+  return h;
+}
+
+bool header_matches(const TTFileHeader& h) {
+  const TTFileHeader expected = make_header(h.entries);
+  return std::equal(h.magic, h.magic + 8, expected.magic) &&
+         h.version == expected.version && h.entry_size == expected.entry_size &&
+         std::equal(h.field_offsets, h.field_offsets + 6, expected.field_offsets) &&
+         h.zobrist_check == expected.zobrist_check && h.entries > 0 &&
+         (h.entries & (h.entries - 1)) == 0;
+}
+
+size_t round_up(size_t n, size_t alignment) {
+  return (n + alignment - 1) / alignment * alignment;
+}
+
+#ifdef __linux__
+// Sets an interleave policy on [mem, mem + len) through the raw syscall, so
+// we don't need libnuma. Nodes come from sysfs ("0-1", "0,2-3", ...).
+void interleave_pages(void* mem, size_t len) {
+  constexpr int MPOL_INTERLEAVE_MODE = 3;
+
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string ranges;
+  if (!(online >> ranges)) return;
+
+  unsigned long nodemask = 0;
+  std::stringstream ss(ranges);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    const size_t dash = range.find('-');
+    const unsigned long first = std::strtoul(range.c_str(), nullptr, 10);
+    const unsigned long last =
+        dash == std::string::npos
+            ? first
+            : std::strtoul(range.c_str() + dash + 1, nullptr, 10);
+    for (unsigned long n = first; n <= last && n < 64; ++n) nodemask |= 1UL << n;
+  }
+
+  // A single node has nothing to interleave over
+  if ((nodemask & (nodemask - 1)) == 0) return;
+  syscall(SYS_mbind, mem, len, MPOL_INTERLEAVE_MODE, &nodemask, 64UL, 0U);
+}
+#endif
+
+}  // namespace
+
+TranspositionTable::~TranspositionTable() {
+  release();
+}
+
+bool TranspositionTable::resize(size_t mb_size, ThreadPool* pool) {
+  size_t new_entries = (std::max<size_t>(1, mb_size) << 20) / sizeof(TTEntry);
+  // Round down to power of 2
+  new_entries = 1ULL << (63 - __builtin_clzll(new_entries));
+
+  const size_t new_bytes = new_entries * sizeof(TTEntry);
+  const size_t new_mapped = round_up(new_bytes, HUGE_PAGE_SIZE);
+  void* mem = nullptr;
+  PageMode new_mode = PageMode::NORMAL;
+  bool new_mmap = false;
+
+#ifdef __linux__
+  // Explicit huge pages only work if the admin reserved some
+  mem = mmap(nullptr, new_mapped, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (mem != MAP_FAILED) {
+    new_mmap = true;
+    new_mode = PageMode::EXPLICIT;
+  } else {
+    mem = mmap(nullptr, new_mapped, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+      mem = nullptr;
+    } else {
+      new_mmap = true;
+      new_mode = madvise(mem, new_mapped, MADV_HUGEPAGE) == 0
+                     ? PageMode::TRANSPARENT
+                     : PageMode::NORMAL;
+    }
+  }
+#endif
+
+  if (!mem) {
+    new_mode = PageMode::NORMAL;
+    mem = std::aligned_alloc(HUGE_PAGE_SIZE, new_mapped);
+    if (!mem) return false;
+  }
+
+#ifdef __linux__
+  // Must happen before the first touch, that is when pages get placed
+  if (numa_interleave && new_mmap) interleave_pages(mem, new_mapped);
+#endif
+
+  release();
+  table = static_cast<TTEntry*>(mem);
+  num_entries = new_entries;
+  mask = new_entries - 1;
+  bytes = new_bytes;
+  mapped_bytes = new_mapped;
+  mode = new_mode;
+  mapping = new_mmap ? mem : nullptr;
+
+  if (pool)
+    clear(*pool);
+  else
+    clear();
+  return true;
+}
+
+void TranspositionTable::clear(ThreadPool& pool) {
+  const size_t threads = pool.size();
+  if (threads == 1) {
+    clear();
+    return;
+  }
+
+  // Slices are whole huge pages, so no page is first touched by two threads
+  const size_t per_page = HUGE_PAGE_SIZE / sizeof(TTEntry);
+  const size_t pages = (num_entries + per_page - 1) / per_page;
+  const size_t pages_per_thread = (pages + threads - 1) / threads;
+
+  pool.run([&](size_t idx) {
+    const size_t begin = std::min(num_entries, idx * pages_per_thread * per_page);
+    const size_t end = std::min(num_entries, begin + pages_per_thread * per_page);
+    std::fill(table + begin, table + end, TTEntry());
+  });
+  pool.wait();
+}
+
+void TranspositionTable::release() {
+  if (!table) return;
+
+#ifdef __linux__
+  if (mapping) {
+    munmap(mapping, mapped_bytes);
+    mapping = nullptr;
+    table = nullptr;
+    return;
+  }
+#endif
+
+  std::free(table);
+  table = nullptr;
+}
+
+size_t TranspositionTable::huge_page_bytes() const {
+  if (mode == PageMode::EXPLICIT) return mapped_bytes;
+  if (mode == PageMode::NORMAL || mode == PageMode::MAPPED_FILE) return 0;
+
+  // Transparent huge pages: find our mapping in smaps and read its
+  // AnonHugePages field
+  std::ifstream smaps("/proc/self/smaps");
+  std::string line;
+  const auto start = reinterpret_cast<uintptr_t>(table);
+  bool in_mapping = false;
+
+  while (std::getline(smaps, line)) {
+    const size_t dash = line.find('-');
+    if (dash != std::string::npos && dash > 0 && line.find(':') > dash &&
+        std::isxdigit(static_cast<unsigned char>(line[0]))) {
+      in_mapping =
+          std::strtoull(line.substr(0, dash).c_str(), nullptr, 16) == start;
+      continue;
+    }
+    if (in_mapping && line.rfind("AnonHugePages:", 0) == 0) {
+      std::istringstream ss(line.substr(14));
+      size_t kb = 0;
+      ss >> kb;
+      return kb << 10;
+    }
+  }
+  return 0;
+}
+
+bool TranspositionTable::save(const std::string& path) const {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) return false;
+
+  const TTFileHeader header = make_header(num_entries);
+  char page[TT_FILE_DATA_OFFSET] = {};
+  std::copy_n(reinterpret_cast<const char*>(&header), sizeof(header), page);
+
+  file.write(page, sizeof(page));
+  file.write(reinterpret_cast<const char*>(table),
+             static_cast<std::streamsize>(bytes));
+  return static_cast<bool>(file.flush());
+}
+
+bool TranspositionTable::load(const std::string& path) {
+#ifdef __linux__
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  TTFileHeader header;
+  struct stat st;
+  const bool valid =
+      pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+      header_matches(header) && fstat(fd, &st) == 0 &&
+      static_cast<uint64_t>(st.st_size) >=
+          TT_FILE_DATA_OFFSET + header.entries * sizeof(TTEntry);
+  if (!valid) {
+    close(fd);
+    return false;
+  }
+
+  // Private, so the search can keep writing without touching the file
+  const size_t file_bytes = static_cast<size_t>(st.st_size);
+  void* mem = mmap(nullptr, file_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED) return false;
+
+  // Probes are random, readahead would only waste I/O
+  madvise(mem, file_bytes, MADV_RANDOM);
+
+  release();
+  mapping = mem;
+  mapped_bytes = file_bytes;
+  table = reinterpret_cast<TTEntry*>(static_cast<char*>(mem) + TT_FILE_DATA_OFFSET);
+  num_entries = header.entries;
+  mask = num_entries - 1;
+  bytes = num_entries * sizeof(TTEntry);
+  mode = PageMode::MAPPED_FILE;
+  return true;
+#else
+  std::ifstream file(path, std::ios::binary);
+  TTFileHeader header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      !header_matches(header))
+    return false;
+
+  const size_t mb = (header.entries * sizeof(TTEntry)) >> 20;
+  if (mb == 0 || !resize(mb) || num_entries != header.entries) return false;
+
+  file.seekg(TT_FILE_DATA_OFFSET);
+  if (!file.read(reinterpret_cast<char*>(table), static_cast<std::streamsize>(bytes))) {
+    clear();
+    return false;
+  }
+  return true;
+#endif
+}
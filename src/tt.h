@@ -7,11 +7,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
-#include <vector>
+#include <string>
 
 #include "move.h"
 
+class ThreadPool;
+
 enum TTFlag : uint8_t {
   TT_NONE = 0,
   TT_EXACT = 1,
@@ -19,36 +23,57 @@ enum TTFlag : uint8_t {
   TT_BETA = 3,
 };
 
+// Static eval slot of entries whose node never computed one
+constexpr int16_t TT_NO_EVAL = INT16_MIN;
+
+// 16 bytes. Only the upper half of the key is kept: the lower bits are
+// already implied by the slot the entry sits in.
 struct TTEntry {
-  uint64_t hash_key;
+  uint32_t hash_key;
   int score;
   Move best_move;
+  int16_t eval;
   uint8_t depth;
   TTFlag flag;
 
-  TTEntry() : hash_key(0), score(0), best_move(Move()), depth(0), flag(TT_NONE) {}
+  TTEntry()
+      : hash_key(0), score(0), best_move(Move()), eval(TT_NO_EVAL), depth(0), flag(TT_NONE) {}
+};
+
+static_assert(sizeof(TTEntry) == 16, "TTEntry must stay 16 bytes");
+
+enum class PageMode : uint8_t {
+  NORMAL,       // plain aligned allocation
+  TRANSPARENT,  // mmap + MADV_HUGEPAGE, the kernel may back it with 2 MB pages
+  EXPLICIT,     // MAP_HUGETLB, reserved huge pages
+  MAPPED_FILE,  // private mapping of a saved table, paged in on first probe
 };
 
 class TranspositionTable {
  public:
-#ifdef DEBUG
-  int hits = 0;
-#endif
-  explicit TranspositionTable(size_t mb_size = 64) {
-    size_t num_entries = (mb_size * 1024 * 1024) / sizeof(TTEntry);
-    // Round down to power of 2
-    num_entries = 1ULL << (63 - __builtin_clzll(num_entries));
-    table.resize(num_entries);
-    mask = num_entries - 1;
+  explicit TranspositionTable(size_t mb_size = 64, ThreadPool* pool = nullptr) {
+    resize(mb_size, pool);
   }
+  ~TranspositionTable();
 
-  void store(uint64_t key, int score, Move move, uint8_t depth, TTFlag flag) {
+  TranspositionTable(const TranspositionTable&) = delete;
+  TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+  // Reallocates (and clears) the table, the old one is kept if the new
+  // allocation fails. Must not be called while a search is running. With a
+  // pool the new memory is first touched by the threads that will use it.
+  bool resize(size_t mb_size, ThreadPool* pool = nullptr);
+
+  void store(uint64_t key, int score, Move move, uint8_t depth, TTFlag flag,
+             int eval = TT_NO_EVAL) {
     size_t index = key & mask;
     TTEntry& entry = table[index];
-    if (entry.hash_key != key || depth >= entry.depth) {
-      entry.hash_key = key;
+    const uint32_t check = static_cast<uint32_t>(key >> 32);
+    if (entry.hash_key != check || depth >= entry.depth) {
+      entry.hash_key = check;
       entry.score = score;
       entry.best_move = move;
+      entry.eval = static_cast<int16_t>(std::clamp(eval, int(TT_NO_EVAL), int(INT16_MAX)));
       entry.depth = depth;
       entry.flag = flag;
     }
@@ -57,23 +82,63 @@ class TranspositionTable {
   TTEntry* probe(uint64_t key) {
     size_t index = key & mask;
     TTEntry& entry = table[index];
-    if (entry.hash_key == key) {
-#ifdef DEBUG
-      hits++;
-#endif
+    if (entry.hash_key == static_cast<uint32_t>(key >> 32) && entry.flag != TT_NONE) {
       return &entry;
     }
     return nullptr;
   }
 
+  // Pulls the entry for key towards L1 while the caller keeps working, so
+  // the probe in the child node does not wait on DRAM
+  void prefetch(uint64_t key) const {
+    if (prefetching) __builtin_prefetch(&table[key & mask]);
+  }
+
+  // Only for measuring what prefetching buys (see bench)
+  void set_prefetch(bool enabled) { prefetching = enabled; }
+
+  // Permille of used entries, sampled over the first 1000 slots
+  int hashfull() const {
+    size_t samples = std::min<size_t>(1000, num_entries);
+    size_t used = 0;
+    for (size_t i = 0; i < samples; ++i) used += table[i].flag != TT_NONE;
+    return static_cast<int>(used * 1000 / samples);
+  }
+
   void clear() {
-#ifdef DEBUG
-    hits = 0;
-#endif
-    std::fill(table.begin(), table.end(), TTEntry());
+    std::fill(table, table + num_entries, TTEntry());
   }
 
+  // Every worker clears its own contiguous, page aligned slice
+  void clear(ThreadPool& pool);
+
+  // Dumps the table to path, see tt.cpp for the file layout
+  bool save(const std::string& path) const;
+  // Replaces the table (and its size) with a saved one. Entries are read
+  // from disk lazily as the search touches them, writes stay in memory.
+  bool load(const std::string& path);
+
+  // Spread the pages of the next allocation round robin over all NUMA
+  // nodes instead of placing them on the node of the touching thread
+  void set_numa_interleave(bool enabled) { numa_interleave = enabled; }
+
+  size_t size_mb() const { return bytes >> 20; }
+  size_t entries() const { return num_entries; }
+  PageMode page_mode() const { return mode; }
+
+  // How much of the table the kernel actually backs with huge pages
+  size_t huge_page_bytes() const;
+
  private:
-  std::vector<TTEntry> table;
-  size_t mask;
+  void release();
+
+  TTEntry* table = nullptr;
+  size_t num_entries = 0;
+  size_t mask = 0;
+  size_t bytes = 0;
+  size_t mapped_bytes = 0;
+  PageMode mode = PageMode::NORMAL;
+  void* mapping = nullptr;  // mmap base when the table lives in a mapping
+  bool numa_interleave = false;
+  bool prefetching = true;
 };
@@ -0,0 +1,304 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "tune.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string_view>
+
+#include "bitboard.h"
+#include "eval_tables.h"
+#include "fen.h"
+#include "packed.h"
+
+namespace Tuner {
+
+namespace {
+
+constexpr const int* TABLES[NUM_PIECES] = {FoChess::pawn_table, FoChess::knight_table,
+                                           FoChess::bishop_table, FoChess::rook_table,
+                                           FoChess::queen_table};
+constexpr const char* TABLE_NAMES[NUM_PIECES] = {"pawn", "knight", "bishop", "rook", "queen"};
+
+// sigmoid(e) = 1 / (1 + 10^(-k e / 400)), with 10^x written as e^(x ln 10)
+double sigmoid_scale(double k) { return k * std::log(10.0) / 400.0; }
+
+// Weight of every (piece, square): its value plus its table entry
+std::array<float, NUM_SQUARES> square_weights(const Params& params) {
+  std::array<float, NUM_SQUARES> w;
+  for (size_t i = 0; i < NUM_SQUARES; ++i)
+    w[i] = static_cast<float>(params[i / 64] + params[NUM_PIECES + i]);
+  return w;
+}
+
+// Loss of one shard, adding the gradient per (piece, square) when grad is
+// not null. Evaluation, loss and the gradient scatter are separate passes,
+// the middle one a flat loop over arrays that the compiler vectorises.
+double shard_pass(const Shard& shard, const std::array<float, NUM_SQUARES>& weights, double k,
+                  double lambda, double* grad) {
+  const size_t n = shard.size();
+  std::vector<float> evals(n);
+  for (size_t i = 0; i < n; ++i) {
+    float e = 0;
+    for (uint32_t j = shard.offsets[i]; j < shard.offsets[i + 1]; ++j) {
+      const uint16_t c = shard.coeffs[j];
+      const float w = weights[c & INDEX_MASK];
+      e += (c & BLACK_SIGN) ? -w : w;
+    }
+    evals[i] = e;
+  }
+
+  const float scale = static_cast<float>(sigmoid_scale(k));
+  const float lam = static_cast<float>(lambda);
+  double total = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const float s = 1.0f / (1.0f + std::exp(-scale * evals[i]));
+    const float from_score = 1.0f / (1.0f + std::exp(-scale * shard.scores[i]));
+    const float err = s - (lam * shard.results[i] + (1.0f - lam) * from_score);
+    total += static_cast<double>(err * err);
+    // evals becomes d(loss) / d(eval)
+    evals[i] = 2.0f * err * s * (1.0f - s) * scale;
+  }
+
+  if (grad) {
+    for (size_t i = 0; i < n; ++i)
+      for (uint32_t j = shard.offsets[i]; j < shard.offsets[i + 1]; ++j) {
+        const uint16_t c = shard.coeffs[j];
+        grad[c & INDEX_MASK] += static_cast<double>((c & BLACK_SIGN) ? -evals[i] : evals[i]);
+      }
+  }
+  return total;
+}
+
+// Mean loss over the data, and its gradient over params when asked
+double evaluate(const Dataset& data, const Params& params, double k, double lambda,
+                ThreadPool& pool, Params* grad) {
+  const auto weights = square_weights(params);
+  std::vector<double> totals(data.shards.size());
+  std::vector<std::array<double, NUM_SQUARES>> grads(grad ? data.shards.size() : 0);
+
+  pool.parallel_for(data.shards.size(), [&](size_t i) {
+    double* g = nullptr;
+    if (grad) {
+      grads[i].fill(0);
+      g = grads[i].data();
+    }
+    totals[i] = shard_pass(data.shards[i], weights, k, lambda, g);
+  });
+
+  const double n = static_cast<double>(std::max<size_t>(1, data.size()));
+  if (grad) {
+    grad->fill(0);
+    for (const auto& g : grads)
+      for (size_t i = 0; i < NUM_SQUARES; ++i) {
+        (*grad)[NUM_PIECES + i] += g[i] / n;
+        (*grad)[i / 64] += g[i] / n;
+      }
+  }
+
+  double total = 0;
+  for (double t : totals) total += t;
+  return total / n;
+}
+
+void add(Shard& shard, const Board& board, float result, float score) {
+  if (!extract(board, shard.coeffs)) return;
+  shard.offsets.push_back(static_cast<uint32_t>(shard.coeffs.size()));
+  shard.results.push_back(result);
+  shard.scores.push_back(score);
+}
+
+// One datagen line: "fen | score | result" or "fen | result"
+void add_line(Shard& shard, const std::string& line) {
+  const size_t first = line.find('|'), last = line.rfind('|');
+  if (first == std::string::npos) return;
+  const float result = std::strtof(line.c_str() + last + 1, nullptr);
+  const float score =
+      first == last ? 0.0f : std::strtof(line.c_str() + first + 1, nullptr);
+  Board board;
+  if (FEN::parse(std::string_view(line).substr(0, first), board) != FEN::Error::NONE) return;
+  add(shard, board, result, score);
+}
+
+bool load_packed(const std::string& path, Dataset& data, ThreadPool& pool) {
+  PackedReader reader;
+  if (!reader.open(path)) return false;
+
+  const size_t per_shard = (reader.size() + data.shards.size() - 1) / data.shards.size();
+  pool.parallel_for(data.shards.size(), [&](size_t s) {
+    const size_t end = std::min(reader.size(), (s + 1) * per_shard);
+    for (size_t i = s * per_shard; i < end; ++i) {
+      const PackedBoard& p = reader[i];
+      if (p.result() == PackedBoard::RESULT_NONE) continue;
+      add(data.shards[s], p.decode(), static_cast<float>(p.result()) / 2.0f, p.score);
+    }
+  });
+  return true;
+}
+
+bool load_text(const std::string& path, Dataset& data, ThreadPool& pool) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+  const std::string text{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+  // Cut the text at line ends close to equal parts
+  std::vector<size_t> cuts{0};
+  for (size_t s = 1; s < data.shards.size(); ++s) {
+    size_t at = std::max(cuts.back(), text.size() * s / data.shards.size());
+    at = text.find('\n', at);
+    cuts.push_back(at == std::string::npos ? text.size() : at + 1);
+  }
+  cuts.push_back(text.size());
+
+  pool.parallel_for(data.shards.size(), [&](size_t s) {
+    std::istringstream in(text.substr(cuts[s], cuts[s + 1] - cuts[s]));
+    std::string line;
+    while (std::getline(in, line)) add_line(data.shards[s], line);
+  });
+  return true;
+}
+
+}  // namespace
+
+size_t Dataset::size() const {
+  size_t n = 0;
+  for (const Shard& s : shards) n += s.size();
+  return n;
+}
+
+Params current_params() {
+  Params params;
+  for (size_t pt = 0; pt < NUM_PIECES; ++pt) {
+    params[pt] = FoChess::piece_values[pt];
+    for (size_t sq = 0; sq < 64; ++sq) params[NUM_PIECES + pt * 64 + sq] = TABLES[pt][sq];
+  }
+  return params;
+}
+
+bool extract(const Board& board, std::vector<uint16_t>& coeffs) {
+  // bland_evaluate hands these to the bitbase
+  if (std::popcount(board.allPieces()) == 3 &&
+      std::popcount(board.pieces(WHITE, PAWN) | board.pieces(BLACK, PAWN)) == 1)
+    return false;
+
+  for (Color c : {WHITE, BLACK})
+    for (size_t pt = 0; pt < NUM_PIECES; ++pt) {
+      Bitboard bb = board.pieces(c, Piece(pt));
+      while (bb) {
+        const size_t sq = Bitboards::pop_lsb(bb);
+        coeffs.push_back(c == WHITE ? static_cast<uint16_t>(pt * 64 + sq)
+                                    : static_cast<uint16_t>((pt * 64 + (sq ^ 56)) | BLACK_SIGN));
+      }
+    }
+  return true;
+}
+
+double linear_eval(const Params& params, const uint16_t* begin, const uint16_t* end) {
+  double score = 0;
+  for (const uint16_t* c = begin; c != end; ++c) {
+    const size_t i = *c & INDEX_MASK;
+    const double w = params[i / 64] + params[NUM_PIECES + i];
+    score += (*c & BLACK_SIGN) ? -w : w;
+  }
+  return score;
+}
+
+bool load(const std::string& path, Dataset& data, ThreadPool& pool) {
+  data.shards.assign(pool.size(), Shard{});
+  const bool packed = path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+  return packed ? load_packed(path, data, pool) : load_text(path, data, pool);
+}
+
+double loss(const Dataset& data, const Params& params, double k, double lambda,
+            ThreadPool& pool) {
+  return evaluate(data, params, k, lambda, pool, nullptr);
+}
+
+double fit_k(const Dataset& data, const Params& params, double lambda, ThreadPool& pool) {
+  // Coarse scan, then narrower ones around the best so far
+  double best = 1.0, best_loss = loss(data, params, best, lambda, pool);
+  double step = 0.5;
+  for (int round = 0; round < 4; ++round) {
+    const double centre = best;
+    for (int i = -5; i <= 5; ++i) {
+      const double k = centre + i * step;
+      if (k <= 0 || i == 0) continue;
+      const double l = loss(data, params, k, lambda, pool);
+      if (l < best_loss) best_loss = l, best = k;
+    }
+    step /= 10;
+  }
+  return best;
+}
+
+void tune(const Dataset& data, Params& params, const Options& options, ThreadPool& pool,
+          const std::function<void(int epoch, double loss)>& report) {
+  constexpr double BETA1 = 0.9, BETA2 = 0.999, EPS = 1e-8;
+  const double k = options.k > 0 ? options.k : fit_k(data, params, options.lambda, pool);
+
+  Params m{}, v{}, grad;
+  double beta1_t = 1, beta2_t = 1;
+  for (int epoch = 1; epoch <= options.epochs; ++epoch) {
+    const double l = evaluate(data, params, k, options.lambda, pool, &grad);
+    if (report) report(epoch, l);
+
+    beta1_t *= BETA1;
+    beta2_t *= BETA2;
+    for (size_t i = 0; i < NUM_PARAMS; ++i) {
+      m[i] = BETA1 * m[i] + (1 - BETA1) * grad[i];
+      v[i] = BETA2 * v[i] + (1 - BETA2) * grad[i] * grad[i];
+      const double m_hat = m[i] / (1 - beta1_t), v_hat = v[i] / (1 - beta2_t);
+      params[i] -= options.lr * m_hat / (std::sqrt(v_hat) + EPS);
+    }
+  }
+}
+
+std::string to_header(const Params& params) {
+  auto round = [](double x) { return static_cast<int>(std::lround(x)); };
+
+  std::ostringstream out;
+  out << "// -----------------------------------------------------------------------------\n"
+         "//  FoChess\n"
+         "//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.\n"
+         "//\n"
+         "//  Read the LICENSE file in the project root please.\n"
+         "// -----------------------------------------------------------------------------\n"
+         "\n"
+         "// Material and piece-square tables, from white's side with A8 first.\n"
+         "// Written by the tuner (test/tune.cpp), edit with care.\n"
+         "\n"
+         "#pragma once\n"
+         "\n"
+         "namespace FoChess {\n"
+         "\n"
+         "inline constexpr int piece_values[5] = {";
+  for (size_t pt = 0; pt < NUM_PIECES; ++pt) out << (pt ? ", " : "") << round(params[pt]);
+  out << "};\n";
+
+  for (size_t pt = 0; pt < NUM_PIECES; ++pt) {
+    out << "\ninline constexpr int " << TABLE_NAMES[pt] << "_table[64] = {\n";
+    for (size_t row = 0; row < 8; ++row) {
+      out << "  ";
+      for (size_t file = 0; file < 8; ++file) {
+        const std::string v = std::to_string(round(params[NUM_PIECES + pt * 64 + row * 8 + file]));
+        out << std::string(v.size() < 5 ? 5 - v.size() : 0, ' ') << v << ",";
+      }
+      out << "\n";
+    }
+    out << "};\n";
+  }
+  out << "\n}  // namespace FoChess\n";
+  return out.str();
+}
+
+}  // namespace Tuner
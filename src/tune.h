@@ -0,0 +1,91 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "thread.h"
+
+/**
+ * Texel tuning of the material and piece-square tables. bland_evaluate is
+ * linear in them: every piece other than a king adds its value plus its
+ * square's entry, so a position boils down to a short list of (piece,
+ * square) weights counted +1 for white and -1 for black. Those lists are
+ * extracted once when loading, after which an epoch is a pass over flat
+ * arrays with no boards involved.
+ */
+namespace Tuner {
+
+constexpr size_t NUM_PIECES = 5;
+constexpr size_t NUM_SQUARES = NUM_PIECES * 64;
+// Piece values first, then the tables in piece order
+constexpr size_t NUM_PARAMS = NUM_PIECES + NUM_SQUARES;
+
+using Params = std::array<double, NUM_PARAMS>;
+
+// A (piece, square) index, BLACK_SIGN set when it counts against white
+constexpr uint16_t BLACK_SIGN = 0x8000;
+constexpr uint16_t INDEX_MASK = 0x7FFF;
+
+// Part of the data, owned by one worker
+struct Shard {
+  std::vector<uint16_t> coeffs;
+  std::vector<uint32_t> offsets{0};  // position i is [offsets[i], offsets[i + 1])
+  std::vector<float> results;        // 1, 0.5 or 0 for white
+  std::vector<float> scores;         // search score for white, if known
+  size_t size() const { return results.size(); }
+};
+
+struct Dataset {
+  std::vector<Shard> shards;
+  size_t size() const;
+};
+
+struct Options {
+  int epochs = 1000;
+  double lr = 1.0;  // in centipawns per step
+  double k = 0;     // 0 to fit it to the data first
+  // Target is lambda * result + (1 - lambda) * sigmoid(score)
+  double lambda = 1.0;
+};
+
+// The weights evaluate.cpp is built with
+Params current_params();
+
+// Appends the coefficients of board, false for positions bland_evaluate
+// does not score linearly (the KPK bitbase)
+bool extract(const Board& board, std::vector<uint16_t>& coeffs);
+
+// Score for white, matching bland_evaluate with integer params
+double linear_eval(const Params& params, const uint16_t* begin, const uint16_t* end);
+
+// "fen | score | result" lines as written by datagen, or PackedBoard records
+// for files ending in .bin. Positions are spread over one shard per worker.
+bool load(const std::string& path, Dataset& data, ThreadPool& pool);
+
+double loss(const Dataset& data, const Params& params, double k, double lambda,
+            ThreadPool& pool);
+
+// Scaling constant of the sigmoid that best fits the current weights
+double fit_k(const Dataset& data, const Params& params, double lambda, ThreadPool& pool);
+
+// Adam over the full data. report is called every epoch with the loss
+// before the step.
+void tune(const Dataset& data, Params& params, const Options& options, ThreadPool& pool,
+          const std::function<void(int epoch, double loss)>& report);
+
+// eval_tables.h for the given params, rounded
+std::string to_header(const Params& params);
+
+}  // namespace Tuner
@@ -26,6 +26,16 @@ enum Piece : uint8_t { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING, NO_PIECE };
 
 enum Color : uint8_t { WHITE, BLACK, NO_COLOR };
 
+// One bit per right, the set of them also indexes the Zobrist castling keys
+enum CastlingRight : uint8_t {
+  NO_CASTLING = 0,
+  WHITE_KINGSIDE = 1,
+  WHITE_QUEENSIDE = 2,
+  BLACK_KINGSIDE = 4,
+  BLACK_QUEENSIDE = 8,
+  ANY_CASTLING = 15
+};
+
 /**
  * This is initialised to empty squares so that the generation
  * of boards is simplified.
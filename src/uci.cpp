@@ -9,6 +9,8 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <ostream>
 #include <sstream>
@@ -18,8 +20,29 @@
 #include "helpers.h"
 #include "move.h"
 #include "search.h"
+#include "tablebase.h"
 
-UCIengine::UCIengine() : board(FEN::parse()), tt() {}
+namespace {
+
+std::string describe_hash(const TranspositionTable& tt) {
+  const char* pages = tt.page_mode() == PageMode::EXPLICIT      ? "explicit"
+                      : tt.page_mode() == PageMode::TRANSPARENT ? "transparent"
+                      : tt.page_mode() == PageMode::MAPPED_FILE        ? "none (file mapping)"
+                                                                : "none";
+  return "hash " + std::to_string(tt.size_mb()) + " MB, huge pages " + pages + ", " +
+         std::to_string(tt.huge_page_bytes() >> 20) + " MB backed";
+}
+
+}  // namespace
+
+UCIengine::UCIengine() : board(FEN::parse()), tt(64, &pool), out(std::cout) {
+  FoChess::g_search_state.on_iteration = [this] { info(); };
+}
+
+UCIengine::~UCIengine() {
+  stop();
+  FoChess::g_search_state.on_iteration = nullptr;
+}
 
 void UCIengine::loop() {
   std::string line;
@@ -30,12 +53,18 @@ void UCIengine::loop() {
       isready();
     } else if (line == "ucinewgame") {
       ucinewgame();
+    } else if (line.rfind("setoption", 0) == 0) {
+      setoption(line);
     } else if (line.rfind("position", 0) == 0) {
       position(line);
     } else if (line.rfind("go", 0) == 0) {
       go(line);
     } else if (line == "stop") {
       stop();
+    } else if (line == "ponderhit") {
+      ponderhit();
+    } else if (line.rfind("stats", 0) == 0) {
+      stats(line);
     } else if (line == "quit") {
       stop();  // Ensure search stops before quitting
       break;
@@ -44,13 +73,110 @@ void UCIengine::loop() {
 }
 
 void UCIengine::uci() {
-  std::cout << "id name FoChess\n";
-  std::cout << "id author Flavio Milinanni\n";
-  std::cout << "uciok" << std::endl;
+  out.write("id name FoChess\n"
+            "id author Flavio Milinanni\n"
+            "option name MultiPV type spin default 1 min 1 max 256\n"
+            "option name Ponder type check default false\n"
+            "option name Move Overhead type spin default 30 min 0 max 5000\n"
+            "option name Threads type spin default 1 min 1 max 64\n"
+            "option name Hash type spin default 64 min 1 max 65536\n"
+            "option name NUMA Interleave type check default false\n"
+            "option name HashFile type string default fochess.tt\n"
+            "option name Save Hash type button\n"
+            "option name Load Hash type button\n"
+            "option name OwnBook type check default false\n"
+            "option name BookFile type string default book.bin\n"
+            "option name Book Best Move type check default false\n"
+            "option name SyzygyPath type string default <empty>\n"
+            "option name SyzygyProbeLimit type spin default 7 min 0 max 7\n"
+            "option name SyzygyProbeDepth type spin default 1 min 1 max 100\n"
+            "uciok");
+}
+
+void UCIengine::setoption(std::string& line) {
+  std::stringstream ss(line);
+  std::string token, name, value;
+  ss >> token;  // "setoption"
+
+  // Option names can contain spaces: "setoption name <id> [value <x>]"
+  bool in_value = false;
+  while (ss >> token) {
+    if (token == "name") continue;
+    if (token == "value") {
+      in_value = true;
+      continue;
+    }
+    std::string& target = in_value ? value : name;
+    if (!target.empty()) target += ' ';
+    target += token;
+  }
+
+  if (name == "MultiPV") {
+    FoChess::g_search_state.multi_pv = std::clamp(std::atoi(value.c_str()), 1, 256);
+  } else if (name == "Threads") {
+    stop();
+    pool.resize(static_cast<size_t>(std::clamp(std::atoi(value.c_str()), 1,
+                                               static_cast<int>(FoChess::MAX_SEARCH_THREADS))));
+  } else if (name == "Hash") {
+    stop();
+    size_t mb = static_cast<size_t>(std::clamp(std::atoi(value.c_str()), 1, 65536));
+    if (!tt.resize(mb, &pool)) {
+      out.write("info string could not allocate " + std::to_string(mb) +
+                " MB, keeping " + std::to_string(tt.size_mb()) + " MB");
+      return;
+    }
+    out.write("info string " + describe_hash(tt));
+  } else if (name == "HashFile") {
+    hash_file = value;
+  } else if (name == "Save Hash") {
+    stop();
+    out.write(tt.save(hash_file) ? "info string saved hash to " + hash_file
+                                 : "info string could not save hash to " + hash_file);
+  } else if (name == "Load Hash") {
+    stop();
+    if (tt.load(hash_file))
+      out.write("info string loaded " + hash_file + ", " + describe_hash(tt));
+    else
+      out.write("info string could not load hash from " + hash_file);
+  } else if (name == "OwnBook") {
+    own_book = value == "true";
+    if (own_book && !book.is_open()) open_book();
+  } else if (name == "BookFile") {
+    book_file = value;
+    if (own_book) open_book();
+  } else if (name == "Book Best Move") {
+    book_best = value == "true";
+  } else if (name == "SyzygyPath") {
+    stop();
+    size_t found = Tablebases::init(value == "<empty>" ? "" : value);
+    out.write("info string " + std::to_string(found) + " tablebases, up to " +
+              std::to_string(Tablebases::max_pieces()) + " pieces");
+  } else if (name == "SyzygyProbeLimit") {
+    FoChess::g_search_state.tb_probe_limit = std::clamp(std::atoi(value.c_str()), 0, 7);
+  } else if (name == "SyzygyProbeDepth") {
+    FoChess::g_search_state.tb_probe_depth = std::clamp(std::atoi(value.c_str()), 1, 100);
+  } else if (name == "NUMA Interleave") {
+    // Takes effect with the next Hash allocation
+    tt.set_numa_interleave(value == "true");
+  } else if (name == "Move Overhead") {
+    move_overhead = std::clamp<int64_t>(std::atoll(value.c_str()), 0, 5000);
+  } else if (name == "Ponder") {
+    // Nothing to configure, the GUI decides when to send "go ponder"
+  } else {
+    out.write("info string unknown option " + name);
+  }
+}
+
+void UCIengine::open_book() {
+  if (!book.open(book_file)) {
+    out.write("info string could not open book " + book_file);
+    return;
+  }
+  out.write("info string book " + book_file + ", " + std::to_string(book.size()) + " entries");
 }
 
 void UCIengine::isready() {
-  std::cout << "readyok" << std::endl;
+  out.write("readyok");
 }
 
 void UCIengine::position(std::string& line) {
@@ -85,11 +211,11 @@ void UCIengine::go(std::string& line) {
   ss >> token;  // Skip "go"
 
   uint8_t depth = 64;  // Max depth by default
-  int64_t movetime = 0;
+  uint64_t node_limit = 0;
   int64_t wtime = 0, btime = 0;
   int64_t winc = 0, binc = 0;
-  int movestogo = 30;  // Default moves to go
-  bool infinite = false;
+  FoChess::TimeControl tc;
+  bool ponder = false;
 
   while (ss >> token) {
     if (token == "depth") {
@@ -97,7 +223,7 @@ void UCIengine::go(std::string& line) {
       ss >> temp_depth;
       depth = static_cast<uint8_t>(temp_depth);
     } else if (token == "movetime") {
-      ss >> movetime;
+      ss >> tc.movetime;
     } else if (token == "wtime") {
       ss >> wtime;
     } else if (token == "btime") {
@@ -106,90 +232,170 @@ void UCIengine::go(std::string& line) {
       ss >> winc;
     } else if (token == "binc") {
       ss >> binc;
+    } else if (token == "nodes") {
+      ss >> node_limit;
     } else if (token == "movestogo") {
-      ss >> movestogo;
+      ss >> tc.movestogo;
     } else if (token == "infinite") {
-      infinite = true;
+      tc.infinite = true;
+    } else if (token == "ponder") {
+      ponder = true;
     }
   }
 
-  int64_t time_for_move = 0;
-
-  if (movetime > 0) {
-    time_for_move = std::max<int64_t>(10, movetime - 50);
-  } else if (!infinite) {
-    int64_t our_time = (board.sideToMove == WHITE) ? wtime : btime;
-    int64_t our_inc = (board.sideToMove == WHITE) ? winc : binc;
-
-    if (our_time > 0) {
-      time_for_move = our_time / 20 + our_inc / 2;
-      time_for_move = std::clamp<int64_t>(time_for_move, 20, our_time - 200);
+  // Book moves are played instantly, analysis and pondering always search
+  if (own_book && book.is_open() && !tc.infinite && !ponder) {
+    Move book_move = book.probe(board, book_best);
+    if (book_move.raw() != EMPTY_MOVE) {
+      out.write("bestmove " + PrintingHelpers::move_to_str(book_move));
+      return;
     }
   }
 
-  FoChess::g_search_state.should_stop.store(false, std::memory_order_relaxed);
-  FoChess::g_search_state.time_limit.store(time_for_move,
-                                           std::memory_order_relaxed);
-  is_searching = true;
+  tc.time = (board.sideToMove == WHITE) ? wtime : btime;
+  tc.inc = (board.sideToMove == WHITE) ? winc : binc;
+
+  FoChess::TimeManager& tm = FoChess::g_search_state.time_manager;
+  tm.init(tc, move_overhead);
 
-  search_thread =
-      std::thread(&UCIengine::search_thread_func, this, depth, time_for_move);
-  search_thread.detach();
+  // While pondering the search runs unlimited, our clock only starts to
+  // count on ponderhit
+  FoChess::g_search_state.pondering.store(ponder, std::memory_order_relaxed);
+  FoChess::g_search_state.node_limit = node_limit;
+
+  FoChess::start_search(pool, depth, board, tt, [this] { report_bestmove(); });
+  if (!ponder) FoChess::set_time_limit(tm.hard_deadline());
 }
 
-void UCIengine::search_thread_func(uint8_t depth, [[maybe_unused]] int64_t time_ms) {
-  FoChess::iterative_deepening(depth, board, tt);
+// Runs on the main search thread once its search is over
+void UCIengine::report_bestmove() {
+  // A finished ponder search must hold its bestmove until the GUI
+  // answers with ponderhit or stop
+  {
+    std::unique_lock<std::mutex> lock(ponder_mutex);
+    ponder_cv.wait(lock, [] {
+      return !FoChess::g_search_state.pondering.load(
+                 std::memory_order_relaxed) ||
+             FoChess::g_search_state.should_stop.load(
+                 std::memory_order_relaxed);
+    });
+  }
 
   Move best = FoChess::g_search_stats.best_move.load(std::memory_order_relaxed);
 
   if (best.raw() != EMPTY_MOVE) {
-    info();
-    std::string move_str = PrintingHelpers::move_to_str(best);
-    std::cout << "bestmove " << move_str << std::endl;
+    std::string bestmove = "bestmove " + PrintingHelpers::move_to_str(best);
+
+    const FoChess::PVLine& pv = FoChess::g_search_stats.pv;
+    if (pv.length > 1 && pv.moves[0] == best)
+      bestmove += " ponder " + PrintingHelpers::move_to_str(pv.moves[1]);
+
+    out.write(bestmove);
   }
-  is_searching = false;
+}
+
+void UCIengine::ponderhit() {
+  if (!FoChess::g_search_state.pondering.load(std::memory_order_relaxed))
+    return;
+
+  // The search keeps its TT and iterations, it just becomes a timed search
+  // whose clock starts now
+  FoChess::TimeManager& tm = FoChess::g_search_state.time_manager;
+  tm.start(FoChess::g_search_stats.elapsed_ms(FoChess::g_search_state));
+  FoChess::set_time_limit(tm.hard_deadline());
+
+  {
+    std::lock_guard<std::mutex> lock(ponder_mutex);
+    FoChess::g_search_state.pondering.store(false, std::memory_order_relaxed);
+  }
+  ponder_cv.notify_all();
 }
 
 void UCIengine::info() {
   int depth =
       FoChess::g_search_stats.highest_depth.load(std::memory_order_relaxed);
 
-  int score =
-      FoChess::g_search_stats.best_root_score.load(std::memory_order_relaxed);
+  int seldepth =
+      FoChess::g_search_stats.seldepth.load(std::memory_order_relaxed);
 
-  uint64_t nodes =
-      FoChess::g_search_stats.node_count.load(std::memory_order_relaxed);
+  uint64_t nodes = FoChess::g_search_stats.nodes();
 
   int64_t time_ms = FoChess::g_search_stats.elapsed_ms(FoChess::g_search_state);
 
-  std::cout << "info depth " << depth << " score cp " << score << " nodes "
-            << nodes << " time " << time_ms << " nps "
-            << static_cast<uint64_t>(
-                   FoChess::g_search_stats.nps(FoChess::g_search_state))
-            << std::endl;
-}
+  uint64_t nps = static_cast<uint64_t>(
+      FoChess::g_search_stats.nps(FoChess::g_search_state));
 
-void UCIengine::stop() {
-  if (is_searching) {
-    FoChess::g_search_state.should_stop.store(true, std::memory_order_relaxed);
+  int hashfull = tt.hashfull();
+  uint64_t tbhits = FoChess::g_search_stats.tb_hits();
+
+  const auto& lines = FoChess::g_search_stats.lines;
+  std::ostringstream ss;
+  for (size_t i = 0; i < lines.size(); ++i) {
+    const int score = lines[i].score;
+
+    ss << "info depth " << depth << " seldepth " << std::max(depth, seldepth)
+       << " multipv " << i + 1;
 
-    // Wait for search to finish (with timeout)
-    auto wait_start = std::chrono::steady_clock::now();
-    while (is_searching) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (FoChess::is_mate_score(score))
+      ss << " score mate " << FoChess::mate_in(score);
+    else
+      ss << " score cp " << score;
 
-      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                         std::chrono::steady_clock::now() - wait_start)
-                         .count();
+    ss << " nodes " << nodes << " nps " << nps << " time " << time_ms
+       << " hashfull " << hashfull << " tbhits " << tbhits;
 
-      // Timeout after 100ms
-      if (elapsed > 100) break;
+    const FoChess::PVLine& pv = lines[i].pv;
+    if (pv.length > 0) {
+      ss << " pv";
+      for (size_t j = 0; j < pv.length; ++j)
+        ss << ' ' << PrintingHelpers::move_to_str(pv.moves[j]);
     }
+    ss << '\n';
   }
+
+  out.write(ss.str());
+}
+
+// Not part of UCI: "stats" prints the counters of the last search as
+// info strings, "stats json [file]" dumps them as JSON
+void UCIengine::stats(std::string& line) {
+  std::stringstream ss(line);
+  std::string token, format, path;
+  ss >> token >> format >> path;
+
+  FoChess::StatsSnapshot snap = FoChess::g_search_stats.snapshot();
+  if (format != "json") {
+    out.write(snap.to_info_string());
+    return;
+  }
+
+  if (path.empty()) {
+    out.write(snap.to_json());
+    return;
+  }
+
+  std::ofstream file(path);
+  if (!file) {
+    out.write("info string cannot open " + path);
+    return;
+  }
+  file << snap.to_json() << "\n";
+}
+
+void UCIengine::stop() {
+  {
+    std::lock_guard<std::mutex> lock(ponder_mutex);
+    FoChess::g_search_state.should_stop.store(true, std::memory_order_relaxed);
+    FoChess::g_search_state.pondering.store(false, std::memory_order_relaxed);
+  }
+  ponder_cv.notify_all();
+
+  // Every search thread is parked again when this returns
+  pool.wait();
 }
 
 void UCIengine::ucinewgame() {
   stop();  // Justin Case
   board = FEN::parse();
-  tt.clear();
+  tt.clear(pool);
 }
@@ -7,31 +7,53 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
 #include <string>
-#include <thread>
 
 #include "board.h"
+#include "book.h"
+#include "thread.h"
 #include "tt.h"
+#include "writer.h"
 
 class UCIengine {
  public:
   UCIengine();
+  ~UCIengine();
   void loop();
 
  private:
   void uci();
   void isready();
+  void setoption(std::string& line);
   void position(std::string& line);
   void go(std::string& line);
   void stop();
+  void ponderhit();
   void ucinewgame();
   void info();
+  void stats(std::string& line);
 
-  void search_thread_func(uint8_t depth, int64_t time_ms);
+  void report_bestmove();
+  void open_book();
 
   Board board;
+  // Before the table, whose first allocation is touched by the pool
+  ThreadPool pool;
   TranspositionTable tt;
+  BufferedWriter out;
 
-  std::thread search_thread;
-  std::atomic<bool> is_searching{false};
+  // Wakes a finished ponder search on ponderhit or stop
+  std::mutex ponder_mutex;
+  std::condition_variable ponder_cv;
+
+  int64_t move_overhead = 30;
+  std::string hash_file = "fochess.tt";
+
+  OpeningBook book;
+  std::string book_file = "book.bin";
+  bool own_book = false;
+  bool book_best = false;
 };
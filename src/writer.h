@@ -0,0 +1,91 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+/**
+ * Line writer backed by its own thread. Callers only append to a string
+ * under a mutex, the (possibly slow) write to the stream and the flush
+ * happen on the writer thread, so a GUI that reads slowly never blocks
+ * the search. Lines keep the order in which they were written.
+ */
+class BufferedWriter {
+ public:
+  explicit BufferedWriter(std::ostream& os) : out(os) {
+    worker = std::thread(&BufferedWriter::run, this);
+  }
+
+  BufferedWriter(const BufferedWriter&) = delete;
+  BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+  ~BufferedWriter() {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      done = true;
+    }
+    cv.notify_one();
+    worker.join();
+  }
+
+  void write(const std::string& line) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      pending += line;
+      if (line.empty() || line.back() != '\n') pending += '\n';
+    }
+    cv.notify_one();
+  }
+
+  // Bytes as they are, for binary streams
+  void append(const std::string& data) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      pending += data;
+    }
+    cv.notify_one();
+  }
+
+  // Blocks until everything written so far reached the stream
+  void sync() {
+    std::unique_lock<std::mutex> lock(mtx);
+    drained.wait(lock, [this] { return pending.empty() && !writing; });
+  }
+
+ private:
+  void run() {
+    std::string batch;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+      cv.wait(lock, [this] { return done || !pending.empty(); });
+      if (pending.empty() && done) break;
+
+      batch.swap(pending);
+      writing = true;
+      lock.unlock();
+      out << batch << std::flush;
+      batch.clear();
+      lock.lock();
+      writing = false;
+      drained.notify_all();
+    }
+  }
+
+  std::ostream& out;
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::condition_variable drained;
+  std::string pending;
+  bool writing = false;
+  bool done = false;
+  std::thread worker;
+};
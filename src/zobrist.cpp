@@ -21,7 +21,7 @@ Bitboard generate_hash(const Board& board) {
 
   for (size_t c = WHITE; c <= BLACK; ++c) {
     for (size_t p = PAWN; p <= KING; ++p) {
-      Bitboard bb = board.pieces[c][p];
+      Bitboard bb = board.pieces(Color(c), Piece(p));
       while (bb) {
         size_t sq = static_cast<size_t>(__builtin_ctzll(bb));
         bb &= bb - 1;
@@ -33,7 +33,7 @@ Bitboard generate_hash(const Board& board) {
   // TODO move this to the make move 
   if (board.enPassant != NO_SQUARE) hash ^= enPassant_keys[board.enPassant];
 
-  hash ^= castling_keys[PrintingHelpers::encode_castling(board.castling)];
+  hash ^= castling_keys[board.castling];
 
   if (board.sideToMove == BLACK) hash ^= sideToMove_key;
 
@@ -0,0 +1,122 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+// Analyses a stream of positions, one FEN per line:
+//   analyse [fens | -] [--depth D] [--movetime ms] [--nodes N] [--threads N]
+//           [--hash MB] [--order input | completion]
+// Reads stdin without a file or with "-". Every thread searches one
+// position at a time with its own instance and its share of the hash.
+// Results go to stdout as one JSON object per line, in input order unless
+// asked otherwise; a summary goes to stderr.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "analysis.h"
+#include "bitbase.h"
+#include "magic.h"
+#include "thread.h"
+#include "writer.h"
+#include "zobrist.h"
+
+int main(int argc, char** argv) {
+  std::string in_file = "-";
+  int first_option = 1;
+  if (argc > 1 && argv[1][0] != '-') in_file = argv[first_option++];
+  else if (argc > 1 && std::string(argv[1]) == "-") ++first_option;
+
+  Analysis::Limits limits;
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  size_t hash_mb = 256;
+  bool in_order = true;
+  auto usage = [] {
+    std::cerr << "usage: analyse [fens | -] [--depth D] [--movetime ms] [--nodes N]"
+                 " [--threads N] [--hash MB] [--order input | completion]\n";
+    return 1;
+  };
+  for (int i = first_option; i < argc; i += 2) {
+    // Every option takes a value
+    if (i + 1 == argc) return usage();
+    const std::string arg = argv[i];
+    const std::string value = argv[i + 1];
+    const char* v = value.c_str();
+    if (arg == "--depth") limits.depth = std::clamp(std::atoi(v), 1, FoChess::MAX_PLY - 1);
+    else if (arg == "--movetime") limits.movetime_ms = std::atoll(v);
+    else if (arg == "--nodes") limits.nodes = std::strtoull(v, nullptr, 10);
+    else if (arg == "--threads") threads = std::max<size_t>(1, std::strtoull(v, nullptr, 10));
+    else if (arg == "--hash") hash_mb = std::strtoull(v, nullptr, 10);
+    else if (arg == "--order" && (value == "input" || value == "completion"))
+      in_order = value == "input";
+    else return usage();
+  }
+
+  std::ifstream file;
+  if (in_file != "-") {
+    file.open(in_file);
+    if (!file) {
+      std::cerr << "cannot open " << in_file << "\n";
+      return 1;
+    }
+  }
+  std::istream& in = in_file == "-" ? std::cin : file;
+
+  Zobrist::init_zobrist_keys();
+  Bitboards::init_magic_tables();
+  Bitbases::init();
+
+  BufferedWriter out(std::cout);
+  Analysis::InOrder ordered([&](const std::string& line) { out.write(line); });
+
+  // Lines are read as workers ask for them, so input can be any length
+  std::mutex in_mtx;
+  size_t next_index = 0;
+  auto next_fen = [&](std::string& fen, size_t& index) {
+    std::lock_guard<std::mutex> lock(in_mtx);
+    while (std::getline(in, fen)) {
+      if (!fen.empty() && fen.back() == '\r') fen.pop_back();
+      if (fen.empty() || fen[0] == '#') continue;
+      index = next_index++;
+      return true;
+    }
+    return false;
+  };
+
+  std::atomic<uint64_t> nodes{0};
+  const auto start = std::chrono::steady_clock::now();
+
+  ThreadPool pool(threads);
+  pool.run([&](size_t) {
+    auto search = std::make_unique<FoChess::SearchInstance>();
+    TranspositionTable tt(std::max<size_t>(1, hash_mb / threads));
+
+    std::string fen;
+    size_t index;
+    while (next_fen(fen, index)) {
+      const Analysis::Result r = Analysis::analyse(index, fen, *search, tt, limits);
+      nodes += r.nodes;
+      if (in_order) ordered.push(index, Analysis::to_json(r));
+      else out.write(Analysis::to_json(r));
+    }
+  });
+  pool.wait();
+  out.sync();
+
+  const double secs =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cerr << next_index << " positions, " << nodes << " nodes in " << secs << " s, "
+            << static_cast<uint64_t>(static_cast<double>(nodes) / std::max(secs, 1e-3))
+            << " nps\n";
+  return 0;
+}
@@ -0,0 +1,98 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "analysis.h"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "magic.h"
+#include "thread.h"
+#include "zobrist.h"
+
+int main() {
+  Zobrist::init_zobrist_keys();
+  Bitboards::init_magic_tables();
+
+  // Lines come out in index order whatever order they are pushed in
+  {
+    std::vector<std::string> seen;
+    Analysis::InOrder ordered([&](const std::string& line) { seen.push_back(line); });
+    std::vector<size_t> order(100);
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(3));
+    for (size_t i : order) ordered.push(i, std::to_string(i));
+    assert(seen.size() == 100 && ordered.pending() == 0);
+    for (size_t i = 0; i < seen.size(); ++i) assert(seen[i] == std::to_string(i));
+  }
+
+  auto search = std::make_unique<FoChess::SearchInstance>();
+  TranspositionTable tt(4);
+  Analysis::Limits limits;
+  limits.depth = 4;
+
+  const Analysis::Result mate =
+      Analysis::analyse(7, "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", *search, tt, limits);
+  assert(mate.move == Move(A1, A8) && !mate.pv.empty() && mate.pv[0] == mate.move);
+  const std::string json = Analysis::to_json(mate);
+  std::cout << json << "\n";
+  assert(json.rfind("{\"index\":7,\"fen\":\"6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1\","
+                    "\"bestmove\":\"a1a8\",\"score\":{\"mate\":1},",
+                    0) == 0);
+  assert(json.find("\"pv\":[\"a1a8\"") != std::string::npos && json.back() == '}');
+
+  // A bad fen is reported as such, not searched as whatever was read of it
+  for (const char* bad : {"hello world", "8/8/8/8/8/8/8/8 w - - 0 1"}) {
+    const Analysis::Result r = Analysis::analyse(3, bad, *search, tt, limits);
+    assert(r.error != FEN::Error::NONE && r.nodes == 0 && r.move == Move());
+    const std::string line = Analysis::to_json(r);
+    std::cout << line << "\n";
+    assert(line == "{\"index\":3,\"fen\":\"" + std::string(bad) + "\",\"error\":\"" +
+                       FEN::error_str(r.error) + "\"}");
+  }
+
+  // Many threads each with their own instance agree with one thread
+  std::vector<std::string> fens;
+  {
+    std::ifstream in("resources/bench_fen_list.txt");
+    std::string line;
+    while (std::getline(in, line) && fens.size() < 24)
+      if (!line.empty()) fens.push_back(line);
+  }
+
+  std::vector<std::string> serial;
+  for (size_t i = 0; i < fens.size(); ++i)
+    serial.push_back(Analysis::to_json(Analysis::analyse(i, fens[i], *search, tt, limits)));
+
+  std::vector<std::string> parallel;
+  Analysis::InOrder ordered([&](const std::string& line) { parallel.push_back(line); });
+  std::atomic<size_t> next{0};
+  ThreadPool pool(4);
+  pool.run([&](size_t) {
+    auto own = std::make_unique<FoChess::SearchInstance>();
+    TranspositionTable own_tt(4);
+    for (size_t i = next.fetch_add(1); i < fens.size(); i = next.fetch_add(1))
+      ordered.push(i, Analysis::to_json(Analysis::analyse(i, fens[i], *own, own_tt, limits)));
+  });
+  pool.wait();
+
+  assert(parallel.size() == serial.size());
+  // Times differ from run to run, everything before them must not
+  for (size_t i = 0; i < serial.size(); ++i) {
+    const size_t cut = serial[i].find("\"time_ms\"");
+    assert(parallel[i].compare(0, cut, serial[i], 0, cut) == 0);
+  }
+
+  std::cout << "Analysis tests passed\n";
+  return 0;
+}
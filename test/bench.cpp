@@ -5,19 +5,128 @@
 //  Read the LICENSE file in the project root please.
 // -----------------------------------------------------------------------------
 
+// Usage:
+//   bench [threads]                      search every bench position
+//   bench prefetch [hash_mb] [depth]     NPS with and without TT prefetching
+//   bench fen [rounds]                   FEN parsing and writing, positions/s
+
 #include <chrono>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "fen.h"
 #include "helpers.h"
 #include "magic.h"
 #include "search.h"
+#include "thread.h"
 #include "tt.h"
 #include "zobrist.h"
 
-int main() {
+namespace {
+
+struct BenchResult {
+  uint64_t nodes = 0;
+  int64_t ms = 0;
+
+  uint64_t nps() const {
+    return ms > 0 ? nodes * 1000 / static_cast<uint64_t>(ms) : 0;
+  }
+};
+
+// Runs every position from a cold table, single threaded so both runs of
+// the prefetch comparison search exactly the same tree
+BenchResult run_all(const std::vector<std::string>& fens, TranspositionTable& tt,
+                    ThreadPool& pool, int depth) {
+  BenchResult result;
+  tt.clear(pool);
+  for (const auto& fen : fens) {
+    Board board = FEN::parse(fen);
+    auto start = std::chrono::steady_clock::now();
+    FoChess::start_search(pool, depth, board, tt);
+    pool.wait();
+    auto end = std::chrono::steady_clock::now();
+    result.ms += std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    result.nodes += FoChess::g_search_stats.nodes();
+  }
+  return result;
+}
+
+int prefetch_bench(const std::vector<std::string>& fens, size_t hash_mb, int depth) {
+  TranspositionTable tt(hash_mb);
+  ThreadPool pool(1);
+
+  std::cout << "Hash " << tt.size_mb() << " MB, depth " << depth << ", "
+            << fens.size() << " positions\n";
+
+  tt.set_prefetch(false);
+  BenchResult off = run_all(fens, tt, pool, depth);
+  tt.set_prefetch(true);
+  BenchResult on = run_all(fens, tt, pool, depth);
+
+  std::cout << "Prefetch off: " << off.nodes << " nodes " << off.ms << " ms "
+            << off.nps() << " nps\n";
+  std::cout << "Prefetch on:  " << on.nodes << " nodes " << on.ms << " ms "
+            << on.nps() << " nps\n";
+  if (off.nps() > 0) {
+    double gain = (static_cast<double>(on.nps()) / static_cast<double>(off.nps()) - 1.0) * 100.0;
+    std::cout << "Gain: " << gain << " %\n";
+  }
+  return 0;
+}
+
+// Positions from the perft list, with move counters, as many times over as
+// rounds asks for
+int fen_bench(int rounds) {
+  std::ifstream in("resources/perft_test_list.txt");
+  std::vector<std::string> fens;
+  std::string line;
+  while (std::getline(in, line))
+    if (!line.empty()) fens.push_back(line.substr(0, line.find(';')));
+
+  std::vector<Board> boards(fens.size());
+  for (size_t i = 0; i < fens.size(); ++i)
+    if (FEN::parse(fens[i], boards[i]) != FEN::Error::NONE) {
+      std::cerr << "bad FEN: " << fens[i] << "\n";
+      return 1;
+    }
+
+  const double n = static_cast<double>(fens.size()) * rounds;
+  uint64_t sink = 0;
+  auto report = [&](const char* what, auto&& body) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) body();
+    const double secs =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << what << static_cast<uint64_t>(n / secs) << " positions/s\n";
+  };
+
+  Board board;
+  std::string buffer;
+  report("parse into board   ", [&] {
+    for (const auto& fen : fens) sink += static_cast<uint64_t>(FEN::parse(fen, board)) + board.hash;
+  });
+  report("parse, returned    ", [&] {
+    for (const auto& fen : fens) sink += FEN::parse(fen).hash;
+  });
+  report("append to buffer   ", [&] {
+    for (const auto& b : boards) {
+      buffer.clear();
+      FEN::append(b, buffer, 1);
+      sink += buffer.size();
+    }
+  });
+  report("to_fen             ", [&] {
+    for (const auto& b : boards) sink += FEN::to_fen(b).size();
+  });
+  std::cout << "(" << sink % 10 << ")\n";
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
   std::ifstream fenFile("resources/bench_fen_list.txt");
   if (!fenFile) {
     std::cerr << "Failed to open FEN file.\n";
@@ -25,20 +134,37 @@ int main() {
   }
   Zobrist::init_zobrist_keys();
   Bitboards::init_magic_tables();
-  TranspositionTable tt;
 
+  std::vector<std::string> fens;
   std::string line;
-  int posCount = 0;
-
   while (std::getline(fenFile, line)) {
     if (line.empty() || line[0] == '#') continue;
+    fens.push_back(line);
+  }
+
+  if (argc > 1 && std::string(argv[1]) == "prefetch") {
+    size_t hash_mb = argc > 2 ? std::stoul(argv[2]) : 1024;
+    int depth = argc > 3 ? std::stoi(argv[3]) : 5;
+    return prefetch_bench(fens, hash_mb, depth);
+  }
+
+  if (argc > 1 && std::string(argv[1]) == "fen")
+    return fen_bench(argc > 2 ? std::stoi(argv[2]) : 2000);
+
+  size_t threads = argc > 1 ? std::stoul(argv[1]) : 1;
+  TranspositionTable tt;
+  ThreadPool pool(threads);
+
+  int posCount = 0;
+  for (const auto& fen : fens) {
     ++posCount;
 
-    Board board = FEN::parse(line);
+    Board board = FEN::parse(fen);
 
     auto start = std::chrono::high_resolution_clock::now();
 
-    FoChess::iterative_deepening(5, board, tt);
+    FoChess::start_search(pool, 5, board, tt);
+    pool.wait();
 
     // Find best move (assuming you have this function)
     Move best = FoChess::g_search_stats.best_move.load();
@@ -47,8 +173,8 @@ int main() {
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
 
     std::cout << "Position " << posCount << ":\n";
-    std::cout << "FEN: " << line << "\n";
-    std::cout << "Seen nodes: " << FoChess::g_search_stats.node_count << "\n";
+    std::cout << "FEN: " << fen << "\n";
+    std::cout << "Seen nodes: " << FoChess::g_search_stats.nodes() << "\n";
     std::cout << "Best move: " << PrintingHelpers::move_to_str(best) << "\n";
     std::cout << "Time: " << ms << " ms\n\n";
   }
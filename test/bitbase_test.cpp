@@ -0,0 +1,84 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "bitbase.h"
+
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+#include "evaluate.h"
+#include "fen.h"
+#include "magic.h"
+#include "tablebase_gen.h"
+#include "zobrist.h"
+
+int main() {
+  Zobrist::init_zobrist_keys();
+  Bitboards::init_magic_tables();
+
+  auto t0 = std::chrono::steady_clock::now();
+  Bitbases::init();
+  auto t1 = std::chrono::steady_clock::now();
+  std::cout << "KPK built in "
+            << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms\n";
+
+  // Opposition decides with the pawn on the fifth
+  assert(Bitbases::probe_kpk(E6, E5, E8, WHITE));
+  assert(Bitbases::probe_kpk(E6, E5, E8, BLACK));
+  assert(!Bitbases::probe_kpk(E4, E5, E6, WHITE));
+  assert(!Bitbases::probe_kpk(E4, E5, E6, BLACK));
+  // Rook pawn with the defender in the corner, and mirrored files
+  assert(!Bitbases::probe_kpk(A1, A2, A8, WHITE));
+  assert(!Bitbases::probe_kpk(H1, H2, H8, WHITE));
+  assert(Bitbases::probe_kpk(D6, D5, D8, WHITE) == Bitbases::probe_kpk(E6, E5, E8, WHITE));
+
+  // The evaluator sees it from either side
+  assert(FoChess::bland_evaluate(FEN::parse("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1")) > 5000);
+  assert(FoChess::bland_evaluate(FEN::parse("8/8/8/8/4p3/4k3/8/4K3 w - - 0 1")) < -5000);
+  assert(FoChess::bland_evaluate(FEN::parse("k7/8/8/8/8/8/P7/K7 b - - 0 1")) == 0);
+
+  // Every legal position agrees with the generated tablebase
+  const std::string dir = (std::filesystem::temp_directory_path() / "fochess_kpk_test").string();
+  std::filesystem::remove_all(dir);
+  assert(Tablebases::generate("KPvK", dir));
+  assert(Tablebases::init(dir) > 0);
+
+  size_t checked = 0;
+  for (int p = 8; p < 56; ++p) {
+    for (int wk = 0; wk < 64; ++wk) {
+      for (int bk = 0; bk < 64; ++bk) {
+        if (wk == bk || p == wk || p == bk) continue;
+        for (const Color stm : {WHITE, BLACK}) {
+          std::string fen(64, '1');
+          fen[static_cast<size_t>(p)] = 'P';
+          fen[static_cast<size_t>(wk)] = 'K';
+          fen[static_cast<size_t>(bk)] = 'k';
+          std::string placement;
+          for (size_t row = 0; row < 8; ++row)
+            placement += fen.substr(row * 8, 8) + (row < 7 ? "/" : "");
+          Board board = FEN::parse(placement + (stm == WHITE ? " w - - 0 1" : " b - - 0 1"));
+
+          Tablebases::WDL wdl;
+          if (board.is_in_check(Color(BLACK - stm)) || !Tablebases::probe_wdl(board, wdl))
+            continue;
+          const bool white_wins = wdl == (stm == WHITE ? Tablebases::WDL_WIN
+                                                       : Tablebases::WDL_LOSS);
+          assert(white_wins == Bitbases::probe_kpk(Square(wk), Square(p), Square(bk), stm));
+          ++checked;
+        }
+      }
+    }
+  }
+  std::cout << checked << " positions match the tablebase\n";
+  assert(checked > 300000);
+
+  std::filesystem::remove_all(dir);
+  std::cout << "Bitbase test passed!\n";
+  return 0;
+}
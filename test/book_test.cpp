@@ -0,0 +1,111 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "book.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "fen.h"
+#include "helpers.h"
+#include "magic.h"
+
+namespace {
+
+void put_be(std::ofstream& out, uint64_t v, int bytes) {
+  for (int i = bytes - 1; i >= 0; --i) out.put(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
+
+void add(std::vector<Polyglot::Entry>& entries, const Board& board, const char* uci,
+         uint16_t weight) {
+  Move m = PrintingHelpers::uci_to_move(uci, board);
+  entries.push_back({Polyglot::key(board), Polyglot::encode_move(m), weight, 0});
+}
+
+}  // namespace
+
+int main() {
+  Bitboards::init_magic_tables();
+
+  Board start = FEN::parse();
+
+  // Keys published with the Polyglot format, so third party books match
+  assert(Polyglot::key(start) == Polyglot::STARTPOS_KEY);
+  assert(Polyglot::key(FEN::parse(
+             "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1")) ==
+         0x823C9B50FD114196ULL);
+  assert(Polyglot::key(FEN::parse(
+             "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2")) ==
+         0x0756B94461C50FB0ULL);
+  assert(Polyglot::key(FEN::parse(
+             "rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4")) ==
+         0x00FDD303C946BDD9ULL);
+  assert(Polyglot::key(FEN::parse(
+             "rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4")) ==
+         0x5C3F9B829B279560ULL);
+  Board castle = FEN::parse("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1");
+
+  std::vector<Polyglot::Entry> entries;
+  add(entries, start, "e2e4", 10);
+  add(entries, start, "d2d4", 5);
+  add(entries, castle, "e1g1", 1);
+
+  // Filler so the binary search has something to skip over
+  for (uint64_t i = 0; i < 1000; ++i) entries.push_back({i * 0x9E3779B97F4A7C15ULL, 0, 1, 0});
+
+  std::sort(entries.begin(), entries.end(),
+            [](const auto& a, const auto& b) { return a.key < b.key; });
+  {
+    std::ofstream out("book_test.bin", std::ios::binary);
+    for (const auto& e : entries) {
+      put_be(out, e.key, 8);
+      put_be(out, e.move, 2);
+      put_be(out, e.weight, 2);
+      put_be(out, e.learn, 4);
+    }
+  }
+
+  OpeningBook book;
+  assert(book.open("book_test.bin"));
+  assert(book.size() == entries.size());
+
+  // Best move is the heaviest one, weighted picks see both moves
+  assert(PrintingHelpers::move_to_str(book.probe(start, true)) == "e2e4");
+  int e4 = 0, d4 = 0;
+  for (int i = 0; i < 300; ++i) {
+    std::string m = PrintingHelpers::move_to_str(book.probe(start, false));
+    e4 += m == "e2e4";
+    d4 += m == "d2d4";
+  }
+  assert(e4 + d4 == 300 && e4 > d4 && d4 > 0);
+
+  // Castling is stored as e1h1 and must come back as our castling move
+  Move castling = book.probe(castle, true);
+  assert(castling.type() == CASTLING && castling.to_sq() == G1);
+
+  Board out_of_book = FEN::parse("8/8/8/8/8/8/8/k1K5 w - - 0 1");
+  assert(book.probe(out_of_book, true).raw() == EMPTY_MOVE);
+
+  constexpr int PROBES = 100000;
+  auto t0 = std::chrono::steady_clock::now();
+  size_t found = 0;
+  for (int i = 0; i < PROBES; ++i) found += book.entries(start).size();
+  auto t1 = std::chrono::steady_clock::now();
+  std::cout << "Probe: "
+            << std::chrono::duration<double, std::micro>(t1 - t0).count() / PROBES
+            << " us (" << found / PROBES << " entries)\n";
+
+  book.close();
+  std::remove("book_test.bin");
+  std::cout << "Book test passed!\n";
+  return 0;
+}
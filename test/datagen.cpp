@@ -0,0 +1,114 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+// Generates training data from self-play:
+//   datagen <out> [--games N] [--threads N] [--nodes N] [--depth D]
+//           [--random-plies N] [--hash MB] [--seed S] [--packed]
+// Lines are "fen | score | result", appended to out, or 32 byte
+// PackedBoard records with --packed.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "datagen.h"
+#include "magic.h"
+#include "thread.h"
+#include "writer.h"
+#include "zobrist.h"
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: datagen <out> [--games N] [--threads N] [--nodes N] [--depth D]"
+                 " [--random-plies N] [--hash MB] [--seed S] [--packed]\n";
+    return 1;
+  }
+
+  Datagen::Options options;
+  uint64_t games = 1000;
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  size_t hash_mb = 16;
+  uint64_t seed = std::random_device{}();
+  bool packed = false;
+  for (int i = 2; i < argc; i += 2) {
+    const std::string arg = argv[i];
+    if (arg == "--packed") {
+      packed = true;
+      --i;
+      continue;
+    }
+    if (i + 1 >= argc) break;
+    const char* value = argv[i + 1];
+    if (arg == "--games") games = std::strtoull(value, nullptr, 10);
+    else if (arg == "--threads") threads = std::max<size_t>(1, std::strtoull(value, nullptr, 10));
+    else if (arg == "--nodes") options.nodes = std::strtoull(value, nullptr, 10);
+    else if (arg == "--depth") options.depth = std::atoi(value);
+    else if (arg == "--random-plies") options.random_plies = std::atoi(value);
+    else if (arg == "--hash") hash_mb = std::strtoull(value, nullptr, 10);
+    else if (arg == "--seed") seed = std::strtoull(value, nullptr, 10);
+  }
+  if (!options.nodes && !options.depth) {
+    std::cerr << "either --nodes or --depth must limit the search\n";
+    return 1;
+  }
+
+  Zobrist::init_zobrist_keys();
+  Bitboards::init_magic_tables();
+
+  std::ofstream file(argv[1], std::ios::app | (packed ? std::ios::binary : std::ios::openmode{}));
+  if (!file) {
+    std::cerr << "cannot open " << argv[1] << "\n";
+    return 1;
+  }
+  BufferedWriter out(file);
+
+  std::atomic<uint64_t> next_game{0}, finished{0}, positions{0};
+  const auto start = std::chrono::steady_clock::now();
+
+  ThreadPool pool(std::min<size_t>(threads, games));
+  pool.run([&](size_t idx) {
+    auto search = std::make_unique<FoChess::SearchInstance>();
+    TranspositionTable tt(hash_mb);
+    std::mt19937_64 rng(seed + 0x9E3779B97F4A7C15ULL * (idx + 1));
+
+    while (next_game.fetch_add(1) < games) {
+      const Datagen::GameRecord game = Datagen::play_game(*search, tt, rng, options);
+      if (packed) out.append(Datagen::format_packed(game));
+      else if (!game.samples.empty()) out.write(Datagen::format(game));
+      positions += game.samples.size();
+      ++finished;
+    }
+  });
+
+  auto report = [&] {
+    const double secs =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "games " << finished << " positions " << positions << " pos/s "
+              << static_cast<uint64_t>(static_cast<double>(positions) / std::max(secs, 1e-3))
+              << std::endl;
+  };
+
+  auto last = std::chrono::steady_clock::now();
+  while (pool.busy()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (std::chrono::steady_clock::now() - last >= std::chrono::seconds(10)) {
+      report();
+      last = std::chrono::steady_clock::now();
+    }
+  }
+  pool.wait();
+  out.sync();
+  report();
+  return 0;
+}
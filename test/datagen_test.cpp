@@ -0,0 +1,71 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "datagen.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+#include "fen.h"
+#include "magic.h"
+#include "packed.h"
+#include "zobrist.h"
+
+int main() {
+  Zobrist::init_zobrist_keys();
+  Bitboards::init_magic_tables();
+
+  auto search = std::make_unique<FoChess::SearchInstance>();
+  TranspositionTable tt(4);
+
+  // Node limits stop the search close to the limit
+  {
+    FoChess::ScopedSearch bind(*search);
+    search->state.node_limit = 20000;
+    Board board = FEN::parse();
+    FoChess::iterative_deepening(64, board, tt);
+    const uint64_t nodes = search->stats.nodes();
+    std::cout << "node limited search: " << nodes << " nodes\n";
+    assert(nodes >= 20000 && nodes < 20000 + 2 * 256);
+    search->state.node_limit = 0;
+  }
+
+  std::mt19937_64 rng(1);
+  Datagen::Options options;
+  options.nodes = 2000;
+  const Datagen::GameRecord game = Datagen::play_game(*search, tt, rng, options);
+  assert(game.result != Match::ONGOING && !game.samples.empty());
+  assert(search->state.node_limit == 0);
+
+  for (const Datagen::Sample& s : game.samples) {
+    assert(!s.board.is_in_check(s.board.sideToMove));
+    assert(s.board.piece_on(s.move.to_sq()) == NO_PIECE);
+    assert(std::abs(s.score) < FoChess::TB_WIN_SCORE);
+  }
+
+  const std::string text = Datagen::format(game);
+  assert(static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) == game.samples.size());
+  std::istringstream first(text);
+  std::string line;
+  std::getline(first, line);
+  const std::string result = line.substr(line.rfind('|') + 2);
+  assert(result == "1.0" || result == "0.5" || result == "0.0");
+
+  const Board parsed = FEN::parse(line.substr(0, line.find('|')));
+  assert(parsed.hash == game.samples[0].board.hash);
+
+  const std::string packed = Datagen::format_packed(game);
+  assert(packed.size() == game.samples.size() * sizeof(PackedBoard));
+
+  std::cout << game.samples.size() << " samples, result " << result << "\n";
+  std::cout << "Datagen test passed!\n";
+  return 0;
+}
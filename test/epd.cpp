@@ -0,0 +1,124 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+// Runs an EPD test suite (bm / am / id):
+//   epd <suite.epd> [--movetime ms] [--depth d] [--threads N] [--hash MB]
+//       [--out annotated.epd]
+// Positions are searched in parallel, one search instance and TT per
+// thread, each search itself single threaded.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "epd.h"
+#include "fen.h"
+#include "helpers.h"
+#include "magic.h"
+#include "thread.h"
+#include "zobrist.h"
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: epd <suite.epd> [--movetime ms] [--depth d] [--threads N]"
+                 " [--hash MB] [--out file]\n";
+    return 1;
+  }
+
+  int64_t movetime = 1000;
+  int depth = 64;
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  size_t hash_mb = 16;
+  std::string out_file;
+  for (int i = 2; i + 1 < argc; i += 2) {
+    const std::string arg = argv[i];
+    if (arg == "--movetime") movetime = std::atoll(argv[i + 1]);
+    else if (arg == "--depth") depth = std::atoi(argv[i + 1]);
+    else if (arg == "--threads") threads = std::max<size_t>(1, std::strtoull(argv[i + 1], nullptr, 10));
+    else if (arg == "--hash") hash_mb = std::strtoull(argv[i + 1], nullptr, 10);
+    else if (arg == "--out") out_file = argv[i + 1];
+  }
+
+  Zobrist::init_zobrist_keys();
+  Bitboards::init_magic_tables();
+
+  std::vector<EPD::Position> suite;
+  std::ifstream in(argv[1]);
+  std::string line;
+  while (std::getline(in, line)) {
+    EPD::Position pos;
+    if (EPD::parse(line, pos)) suite.push_back(pos);
+  }
+  if (suite.empty()) {
+    std::cerr << "no positions in " << argv[1] << "\n";
+    return 1;
+  }
+
+  std::vector<EPD::Result> results(suite.size());
+  std::atomic<size_t> next{0};
+  std::mutex print_mtx;
+
+  const auto start = std::chrono::steady_clock::now();
+  ThreadPool pool(std::min(threads, suite.size()));
+  pool.run([&](size_t) {
+    auto search = std::make_unique<FoChess::SearchInstance>();
+    TranspositionTable tt(hash_mb);
+
+    for (size_t i = next.fetch_add(1); i < suite.size(); i = next.fetch_add(1)) {
+      const EPD::Position& pos = suite[i];
+      results[i] = EPD::solve(pos, *search, tt, depth, movetime);
+      const EPD::Result& r = results[i];
+
+      const Board board = FEN::parse(pos.fen);
+      std::lock_guard<std::mutex> lock(print_mtx);
+      std::cout << std::left << std::setw(12) << (pos.id.empty() ? std::to_string(i + 1) : pos.id)
+                << std::setw(8) << (r.solved ? "solved" : "failed") << std::setw(8)
+                << PrintingHelpers::move_to_san(r.move, board);
+      if (!pos.best_moves.empty()) std::cout << " bm " << pos.best_moves[0];
+      if (!pos.avoid_moves.empty()) std::cout << " am " << pos.avoid_moves[0];
+      if (r.solved)
+        std::cout << "  tts " << r.solve_ms << " ms  nts " << r.solve_nodes;
+      std::cout << "  depth " << r.depth << "\n";
+    }
+  });
+  pool.wait();
+  const auto wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+
+  size_t solved = 0;
+  int64_t solve_ms = 0;
+  uint64_t nodes = 0, solve_nodes = 0;
+  for (const EPD::Result& r : results) {
+    nodes += r.nodes;
+    if (!r.solved) continue;
+    ++solved;
+    solve_ms += r.solve_ms;
+    solve_nodes += r.solve_nodes;
+  }
+
+  std::cout << "\nSolved " << solved << " / " << suite.size() << "\n";
+  if (solved)
+    std::cout << "Mean time to solution " << solve_ms / static_cast<int64_t>(solved)
+              << " ms, nodes to solution " << solve_nodes / solved << "\n";
+  std::cout << "Total nodes " << nodes << " in " << wall_ms << " ms wall time\n";
+
+  if (!out_file.empty()) {
+    std::ofstream out(out_file);
+    for (size_t i = 0; i < suite.size(); ++i) out << EPD::annotate(suite[i], results[i]) << "\n";
+  }
+  return 0;
+}
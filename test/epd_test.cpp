@@ -0,0 +1,86 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "epd.h"
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "fen.h"
+#include "helpers.h"
+#include "magic.h"
+#include "zobrist.h"
+
+int main() {
+  Zobrist::init_zobrist_keys();
+  Bitboards::init_magic_tables();
+
+  // Operations, quoted operands may hold ';'
+  EPD::Position pos;
+  assert(EPD::parse("6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - bm Rd8#; id \"mate; one\"; hmvc 3;", pos));
+  assert(pos.fen == "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 3 1");
+  assert(pos.id == "mate; one");
+  assert(pos.best_moves.size() == 1 && pos.best_moves[0] == "Rd8#");
+  assert(!EPD::parse("# comment", pos) && !EPD::parse("   ", pos));
+
+  EPD::Position two;
+  assert(EPD::parse("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - bm Bb5 Bc4; am Ng5;", two));
+  assert(two.best_moves.size() == 2 && two.avoid_moves.size() == 1);
+
+  Board board = FEN::parse(two.fen);
+  assert(PrintingHelpers::move_to_str(PrintingHelpers::san_to_move("Bb5!", board)) == "f1b5");
+  assert(PrintingHelpers::san_to_move("Bb6", board).raw() == EMPTY_MOVE);
+  Board castle = FEN::parse("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1");
+  assert(PrintingHelpers::san_to_move("0-0", castle).type() == CASTLING);
+
+  // Two searches at once, each with its own instance and TT
+  EPD::Position hanging;
+  assert(EPD::parse("4k3/8/8/3q4/8/8/3R4/4K3 w - - bm Rxd5; am Kf2;", hanging));
+
+  EPD::Result results[2];
+  std::thread workers[2];
+  const EPD::Position* positions[2] = {&pos, &hanging};
+  for (size_t i = 0; i < 2; ++i) {
+    workers[i] = std::thread([&, i] {
+      auto search = std::make_unique<FoChess::SearchInstance>();
+      TranspositionTable tt(4);
+      results[i] = EPD::solve(*positions[i], *search, tt, 6, 0);
+    });
+  }
+  for (auto& w : workers) w.join();
+
+  for (const EPD::Result& r : results) {
+    assert(r.solved && r.depth == 6 && r.nodes > 0);
+    assert(r.solve_nodes <= r.nodes && r.solve_ms <= r.time_ms);
+  }
+  assert(FoChess::is_mate_score(results[0].score));
+  // Nothing leaked into the engine's own instance
+  assert(FoChess::g_search_stats.nodes() == 0);
+
+  const std::string annotated = EPD::annotate(pos, results[0]);
+  assert(annotated.find("id \"mate; one\";") != std::string::npos);
+  assert(annotated.find("acd 6;") != std::string::npos);
+  assert(annotated.find("dm 1;") != std::string::npos);
+  assert(annotated.find("pm Rd8#;") != std::string::npos);
+  assert(annotated.find("c0 \"solved\";") != std::string::npos);
+  std::cout << annotated << "\n";
+
+  // A suite answer the engine disagrees with, within a time limit
+  EPD::Position wrong;
+  assert(EPD::parse("3k4/8/3K4/8/8/8/8/Q7 w - - bm Qa7;", wrong));
+  auto search = std::make_unique<FoChess::SearchInstance>();
+  TranspositionTable tt(4);
+  EPD::Result r = EPD::solve(wrong, *search, tt, 64, 200);
+  assert(!r.solved && PrintingHelpers::move_to_str(r.move) == "a1a8");
+  assert(r.time_ms < 1000);
+  assert(EPD::annotate(wrong, r).find("c0 \"failed\";") != std::string::npos);
+
+  std::cout << "EPD test passed!\n";
+  return 0;
+}
@@ -7,10 +7,13 @@
 
 #include <cassert>
 #include <iostream>
+#include <string>
+#include <utility>
 
 #include "board.h"
 #include "helpers.h"
 #include "fen.h"
+#include "zobrist.h"
 
 int main() {
   // Standard starting position FEN
@@ -46,8 +49,60 @@ int main() {
   // Test no castling rights
   std::string noCastle = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w - -";
   Board noCastleBoard = FEN::parse(noCastle);
-  assert(!noCastleBoard.castling.whiteKingside);
-  assert(!noCastleBoard.castling.whiteQueenside);
+  assert(!noCastleBoard.can_castle(WHITE_KINGSIDE));
+  assert(!noCastleBoard.can_castle(WHITE_QUEENSIDE));
+  assert(noCastleBoard.castling == NO_CASTLING);
+
+  // Counters are read, written back on request, and hashes match
+  const std::string full = "r3k2r/8/8/3pP3/8/8/8/R3K2R w Kq d6 12 34";
+  Board fullBoard;
+  uint16_t fullmove = 0;
+  assert(FEN::parse(full, fullBoard, &fullmove) == FEN::Error::NONE);
+  assert(fullBoard.halfMoveClock == 12 && fullmove == 34);
+  assert(fullBoard.enPassant == D6 && fullBoard.kingSq[BLACK] == E8);
+  assert(fullBoard.hash == Zobrist::generate_hash(fullBoard));
+  std::string out = "fen: ";
+  FEN::append(fullBoard, out, fullmove);
+  assert(out == "fen: " + full);
+
+  // An en passant square needs the pawn that just skipped it
+  Board ep;
+  assert(FEN::parse("4k3/8/8/8/3pP3/8/8/4K3 b - e3 0 1", ep) == FEN::Error::NONE);
+  assert(ep.enPassant == E3);
+
+  // Malformed input is reported, never crashes
+  const std::pair<const char*, FEN::Error> bad[] = {
+      {"", FEN::Error::BAD_BOARD},
+      {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP w KQkq -", FEN::Error::BAD_BOARD},
+      {"rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -", FEN::Error::BAD_BOARD},
+      {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNX w KQkq -", FEN::Error::BAD_BOARD},
+      {"rnbqkbnr/ppppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -", FEN::Error::BAD_BOARD},
+      {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq -", FEN::Error::BAD_SIDE},
+      {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w", FEN::Error::BAD_CASTLING},
+      {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KKq -", FEN::Error::BAD_CASTLING},
+      {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e4", FEN::Error::BAD_EN_PASSANT},
+      {"4k3/8/8/3P4/8/8/8/4K3 w - e6 0 1", FEN::Error::BAD_EN_PASSANT},
+      {"4k3/8/8/3Pp3/8/8/8/4K3 b - e6 0 1", FEN::Error::BAD_EN_PASSANT},
+      {"4k3/8/8/8/3pP3/8/8/4K3 w - e3 0 1", FEN::Error::BAD_EN_PASSANT},
+      {"4k3/4p3/8/3Pp3/8/8/8/4K3 w - e6 0 1", FEN::Error::BAD_EN_PASSANT},
+      {"4k3/8/4n3/3Pp3/8/8/8/4K3 w - e6 0 1", FEN::Error::BAD_EN_PASSANT},
+      {"4k3/8/8/8/3pP3/4N3/8/4K3 b - e3 0 1", FEN::Error::BAD_EN_PASSANT},
+      {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0", FEN::Error::BAD_COUNTERS},
+      {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - x 1", FEN::Error::BAD_COUNTERS},
+      {"rnbqqbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", FEN::Error::BAD_KINGS},
+      {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 bm e4;", FEN::Error::TRAILING_DATA},
+  };
+  for (const auto& [fen, error] : bad) {
+    Board b;
+    assert(FEN::parse(fen, b) == error);
+    assert(FEN::error_str(error)[0]);
+  }
+
+  // The lenient version keeps what it could read, with a matching hash
+  const Board epd = FEN::parse("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b Kq - bm e5;");
+  assert(epd.sideToMove == BLACK && epd.can_castle(WHITE_KINGSIDE) &&
+         !epd.can_castle(WHITE_QUEENSIDE));
+  assert(epd.hash == Zobrist::generate_hash(epd));
 
   std::cout << "\nAll tests passed!\n";
   return 0;
@@ -28,12 +28,8 @@ int main() {
   while (true) {
     std::array<Move, MAX_MOVES> moves;
     size_t n = MoveGen::generate_all(board, moves);
-    if (n == 0 || __builtin_popcountl(board.allPieces) < 3) break;
+    if (n == 0 || __builtin_popcountl(board.allPieces()) < 3) break;
 
-    FoChess::g_search_stats.node_count = 0;
-#ifdef DEBUG
-    tt.hits = 0;
-#endif
     auto start = std::chrono::high_resolution_clock::now();
     FoChess::iterative_deepening(6, board, tt);
     auto end = std::chrono::high_resolution_clock::now();
@@ -41,10 +37,9 @@ int main() {
 
     board.makeMove(FoChess::g_search_stats.best_move.load());
 
-#ifdef DEBUG
-    std::cout << "tt hits: " << tt.hits << "\n";
-    tt.hits = 0;
-#endif
+    FoChess::StatsSnapshot stats = FoChess::g_search_stats.snapshot();
+    std::cout << "tt hits: " << stats.tt_hits << " ("
+              << stats.tt_hit_rate() * 100.0 << "%)\n";
     std::cout << "best move score: " << FoChess::g_search_stats.best_root_score.load()
               << " nodes/sec: " << FoChess::g_search_stats.nps(FoChess::g_search_state) << "\n";
 
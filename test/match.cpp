@@ -0,0 +1,209 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+// Plays two UCI engines against each other:
+//   match <engine1> <engine2> [--games N] [--concurrency N] [--openings file]
+//         [--tc base+inc | --movetime ms | --depth d | --nodes n]
+//         [--option Name=Value]... [--pgn file] [--sprt elo0 elo1 alpha beta]
+// Every opening is played twice with colours swapped. Results are from the
+// point of view of engine1.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "magic.h"
+#include "match.h"
+#include "thread.h"
+#include "writer.h"
+#include "zobrist.h"
+
+namespace {
+
+struct Options {
+  std::string engines[2];
+  uint64_t games = 100;
+  size_t concurrency = std::max(1u, std::thread::hardware_concurrency());
+  std::string openings;
+  std::string pgn = "match.pgn";
+  std::vector<std::string> uci_options;
+  Match::Limits limits;
+  Match::Adjudication adj;
+  bool sprt = false;
+  double elo0 = 0, elo1 = 5, alpha = 0.05, beta = 0.05;
+};
+
+bool parse_args(int argc, char** argv, Options& opt) {
+  int engines = 0;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+
+    if (arg == "--games") opt.games = std::strtoull(next().c_str(), nullptr, 10);
+    else if (arg == "--concurrency") opt.concurrency = std::strtoull(next().c_str(), nullptr, 10);
+    else if (arg == "--openings") opt.openings = next();
+    else if (arg == "--pgn") opt.pgn = next();
+    else if (arg == "--option") opt.uci_options.push_back(next());
+    else if (arg == "--movetime") opt.limits.movetime_ms = std::atoll(next().c_str());
+    else if (arg == "--depth") opt.limits.depth = std::atoi(next().c_str());
+    else if (arg == "--nodes") opt.limits.nodes = std::strtoull(next().c_str(), nullptr, 10);
+    else if (arg == "--tc") {
+      // Seconds, "10+0.1"
+      const std::string tc = next();
+      const size_t plus = tc.find('+');
+      opt.limits.base_ms = static_cast<int64_t>(std::atof(tc.substr(0, plus).c_str()) * 1000);
+      if (plus != std::string::npos)
+        opt.limits.inc_ms = static_cast<int64_t>(std::atof(tc.substr(plus + 1).c_str()) * 1000);
+    } else if (arg == "--sprt") {
+      opt.sprt = true;
+      opt.elo0 = std::atof(next().c_str());
+      opt.elo1 = std::atof(next().c_str());
+      opt.alpha = std::atof(next().c_str());
+      opt.beta = std::atof(next().c_str());
+    } else if (arg.rfind("--", 0) == 0 || engines == 2) {
+      return false;
+    } else {
+      opt.engines[engines++] = arg;
+    }
+  }
+
+  const Match::Limits& l = opt.limits;
+  if (!l.base_ms && !l.movetime_ms && !l.depth && !l.nodes) opt.limits.movetime_ms = 100;
+  return engines == 2 && opt.concurrency > 0;
+}
+
+// FEN or EPD lines, EPD operations after the fourth field are dropped
+std::vector<std::string> read_openings(const std::string& file) {
+  std::vector<std::string> fens;
+  std::ifstream in(file);
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream ss(line);
+    std::vector<std::string> fields;
+    std::string f;
+    while (fields.size() < 6 && ss >> f) fields.push_back(f);
+    if (fields.size() < 4 || fields[0][0] == '#') continue;
+
+    const bool counters = fields.size() == 6 &&
+                          std::all_of(fields[4].begin(), fields[4].end(), ::isdigit) &&
+                          std::all_of(fields[5].begin(), fields[5].end(), ::isdigit);
+    std::string fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3];
+    fen += counters ? " " + fields[4] + " " + fields[5] : " 0 1";
+    fens.push_back(fen);
+  }
+  return fens;
+}
+
+bool start_engine(Match::EngineProcess& engine, const std::string& path,
+                  const std::vector<std::string>& uci_options) {
+  if (!engine.start(path)) return false;
+  for (const std::string& o : uci_options) {
+    const size_t eq = o.find('=');
+    engine.send("setoption name " + o.substr(0, eq) + " value " +
+                (eq == std::string::npos ? "" : o.substr(eq + 1)));
+  }
+  return engine.sync();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parse_args(argc, argv, opt)) {
+    std::cerr << "usage: match <engine1> <engine2> [--games N] [--concurrency N]\n"
+                 "  [--openings file] [--tc base+inc | --movetime ms | --depth d | --nodes n]\n"
+                 "  [--option Name=Value]... [--pgn file] [--sprt elo0 elo1 alpha beta]\n";
+    return 1;
+  }
+
+  Zobrist::init_zobrist_keys();
+  Bitboards::init_magic_tables();
+
+  std::vector<std::string> openings;
+  if (!opt.openings.empty()) openings = read_openings(opt.openings);
+  if (openings.empty()) openings.push_back("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+
+  std::ofstream pgn_file(opt.pgn, std::ios::app);
+  BufferedWriter pgn(pgn_file);
+
+  const auto [lower, upper] = Match::sprt_bounds(opt.alpha, opt.beta);
+  std::mutex mtx;
+  std::atomic<uint64_t> next_game{0};
+  std::atomic<bool> finished{false};
+  uint64_t wins = 0, draws = 0, losses = 0;
+
+  auto report = [&] {
+    const uint64_t n = wins + draws + losses;
+    std::cout << "Games " << n << ": +" << wins << " -" << losses << " =" << draws
+              << std::fixed << std::setprecision(1)
+              << "  Elo " << Match::elo(wins, draws, losses) << " +/- "
+              << Match::elo_error(wins, draws, losses);
+    if (opt.sprt)
+      std::cout << std::setprecision(2) << "  LLR "
+                << Match::sprt_llr(wins, draws, losses, opt.elo0, opt.elo1) << " ["
+                << lower << ", " << upper << "]";
+    std::cout << std::endl;
+  };
+
+  ThreadPool pool(std::min<size_t>(opt.concurrency, opt.games));
+  pool.run([&](size_t) {
+    // engines[0] is always engine1
+    std::unique_ptr<Match::EngineProcess> engines[2] = {
+        std::make_unique<Match::EngineProcess>(), std::make_unique<Match::EngineProcess>()};
+
+    while (!finished.load()) {
+      const uint64_t g = next_game.fetch_add(1);
+      if (g >= opt.games) break;
+
+      for (size_t e = 0; e < 2; ++e) {
+        if (engines[e]->running()) continue;
+        if (!start_engine(*engines[e], opt.engines[e], opt.uci_options)) {
+          std::cerr << "cannot start " << opt.engines[e] << "\n";
+          finished = true;
+          return;
+        }
+      }
+
+      const bool swapped = g % 2;
+      Match::Game game = Match::play_game(
+          *engines[swapped ? 1 : 0], *engines[swapped ? 0 : 1],
+          openings[(g / 2) % openings.size()], opt.limits, opt.adj);
+      game.round = static_cast<int>(g + 1);
+
+      std::lock_guard<std::mutex> lock(mtx);
+      pgn.write(Match::to_pgn(game));
+      if (game.result == Match::DRAWN) ++draws;
+      else if ((game.result == Match::WHITE_WINS) != swapped) ++wins;
+      else ++losses;
+      report();
+
+      if (opt.sprt) {
+        const double llr = Match::sprt_llr(wins, draws, losses, opt.elo0, opt.elo1);
+        if (llr <= lower || llr >= upper) {
+          std::cout << "SPRT " << (llr >= upper ? "H1 accepted" : "H0 accepted") << std::endl;
+          finished = true;
+        }
+      }
+    }
+  });
+  pool.wait();
+  pgn.sync();
+
+  std::cout << "Final: ";
+  report();
+  return 0;
+}
@@ -0,0 +1,106 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "match.h"
+
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+
+#include "fen.h"
+#include "helpers.h"
+#include "magic.h"
+#include "zobrist.h"
+
+namespace {
+
+std::string san(const std::string& fen, const std::string& uci) {
+  Board board = FEN::parse(fen);
+  return PrintingHelpers::move_to_san(PrintingHelpers::uci_to_move(uci, board), board);
+}
+
+Match::GameResult judge(const std::string& fen) {
+  std::string reason;
+  return Match::adjudicate(FEN::parse(fen), {}, reason);
+}
+
+}  // namespace
+
+int main(int, char** argv) {
+  Zobrist::init_zobrist_keys();
+  Bitboards::init_magic_tables();
+
+  // SAN
+  assert(san("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "g1f3") == "Nf3");
+  assert(san("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "e1g1") == "O-O");
+  assert(san("r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1", "e8c8") == "O-O-O");
+  assert(san("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6") == "exd6");
+  assert(san("8/4P1k1/8/8/8/8/8/4K3 w - - 0 1", "e7e8q") == "e8=Q");
+  assert(san("6k1/5ppp/8/8/8/8/8/R3K3 w - - 0 1", "a1a8") == "Ra8#");
+  assert(san("4k3/8/8/8/R6R/8/8/4K3 w - - 0 1", "a4d4") == "Rad4");
+  assert(san("4k3/8/8/8/8/R7/8/R3K3 w - - 0 1", "a1a2") == "R1a2");
+  assert(san("4k3/8/8/1N6/8/1N3N2/8/4K3 w - - 0 1", "b3d4") == "Nb3d4");
+  assert(san("4k3/8/8/8/8/8/8/4K2R w K - 0 1", "h1h8") == "Rh8+");
+
+  // Rules
+  assert(judge("R6k/8/6K1/8/8/8/8/8 b - - 0 1") == Match::WHITE_WINS);
+  assert(judge("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1") == Match::DRAWN);
+  assert(judge("4k3/8/8/8/8/8/1B6/2B1K3 w - - 0 1") == Match::DRAWN);
+  assert(judge("4k3/8/8/8/8/8/8/2B1KB2 w - - 0 1") == Match::ONGOING);
+  assert(judge("4k3/8/8/8/8/8/8/4K1N1 w - - 0 1") == Match::DRAWN);
+  assert(judge("4k3/8/8/8/8/8/8/R3K3 w - - 100 80") == Match::DRAWN);
+
+  Board board = FEN::parse();
+  std::vector<uint64_t> history;
+  std::string reason;
+  for (const char* m : {"g1f3", "g8f6", "f3g1", "f6g8", "g1f3", "g8f6", "f3g1", "f6g8"}) {
+    assert(Match::adjudicate(board, history, reason) == Match::ONGOING);
+    history.push_back(board.hash);
+    board.makeMove(PrintingHelpers::uci_to_move(m, board));
+  }
+  assert(Match::adjudicate(board, history, reason) == Match::DRAWN);
+  assert(reason == "threefold repetition");
+
+  // Statistics
+  assert(Match::elo(10, 0, 10) == 0);
+  assert(std::abs(Match::elo(75, 0, 25) - 190.85) < 0.1);
+  assert(Match::elo_error(500, 0, 500) > 0 && Match::elo_error(500, 0, 500) < 40);
+  const auto [lower, upper] = Match::sprt_bounds(0.05, 0.05);
+  assert(std::abs(lower + 2.944) < 1e-3 && std::abs(upper - 2.944) < 1e-3);
+  assert(Match::sprt_llr(1200, 0, 800, 0, 5) > upper);
+  assert(Match::sprt_llr(400, 0, 600, 0, 5) < lower);
+
+  // PGN of a game starting with black to move
+  Match::Game game;
+  game.white = "A";
+  game.black = "B";
+  game.start_fen = "4k3/8/8/8/8/8/8/R3K3 b - - 0 30";
+  game.san = {"Kd7", "Ra7+"};
+  game.result = Match::DRAWN;
+  game.reason = "test";
+  const std::string pgn = Match::to_pgn(game);
+  assert(pgn.find("[SetUp \"1\"]") != std::string::npos);
+  assert(pgn.find("30... Kd7 31. Ra7+ {test} 1/2-1/2") != std::string::npos);
+
+  // A real game between two copies of the engine, when it was built too
+  const auto engine = std::filesystem::path(argv[0]).parent_path() / "uci_engine";
+  if (std::filesystem::exists(engine)) {
+    Match::EngineProcess a, b;
+    assert(a.start(engine.string()) && b.start(engine.string()));
+    assert(a.name() == "FoChess");
+
+    Match::Limits limits;
+    limits.depth = 2;
+    Match::Game g = Match::play_game(a, b, "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1", limits, {});
+    assert(!g.san.empty() && g.result != Match::ONGOING);
+    std::cout << Match::to_pgn(g);
+  }
+
+  std::cout << "Match test passed!\n";
+  return 0;
+}
@@ -5,15 +5,102 @@
 //  Read the LICENSE file in the project root please.
 // -----------------------------------------------------------------------------
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include "board.h"
 #include "fen.h"
 #include "helpers.h"
+#include "magic.h"
+#include "movegen.h"
 #include "types.h"
 #include "zobrist.h"
 
+// key_after must predict the incremental hash for every kind of move
+void check_key_after(const Board& board, int depth) {
+  if (depth == 0) return;
+  std::array<Move, MAX_MOVES> moves;
+  size_t n = MoveGen::generate_all(board, moves);
+  for (size_t i = 0; i < n; ++i) {
+    Board tmp = board;
+    tmp.makeMove(moves[i]);
+    assert(board.key_after(moves[i]) == tmp.hash);
+    check_key_after(tmp, depth - 1);
+  }
+}
+
+// checkers and gives_check must agree with a full attack scan
+void check_checks(const Board& board, int depth) {
+  if (depth == 0) return;
+  const CheckInfo ci = board.check_info();
+  std::array<Move, MAX_MOVES> moves;
+  size_t n = MoveGen::generate_all(board, moves);
+  for (size_t i = 0; i < n; ++i) {
+    Board tmp = board;
+    tmp.makeMove(moves[i]);
+    const Color them = Color(BLACK - tmp.sideToMove);
+    assert(tmp.checkers == tmp.attacks_to(tmp.kingSq[tmp.sideToMove], them));
+    assert(board.gives_check(moves[i], ci) == (tmp.checkers != 0));
+    check_checks(tmp, depth - 1);
+  }
+}
+
+// Every encodable move passes is_pseudo_legal and isLegalMove exactly
+// when the generator produces it
+void check_pseudo_legal(const Board& board) {
+  std::array<Move, MAX_MOVES> moves;
+  const size_t n = MoveGen::generate_all(board, moves);
+  size_t accepted = 0;
+  for (size_t from = 0; from < 64; ++from) {
+    for (size_t to = 0; to < 64; ++to) {
+      const Square f = Square(from), t = Square(to);
+      const Move candidates[] = {Move(f, t), Move(f, t, EN_PASSANT), Move(f, t, CASTLING),
+                                 Move(f, t, KNIGHT), Move(f, t, BISHOP), Move(f, t, ROOK),
+                                 Move(f, t, QUEEN)};
+      for (const Move& m : candidates) {
+        const bool generated = std::find(moves.begin(), moves.begin() + n, m) != moves.begin() + n;
+        const bool pseudo = board.is_pseudo_legal(m);
+        assert(!generated || pseudo);
+        if (pseudo && board.isLegalMove(m)) {
+          assert(generated);
+          ++accepted;
+        }
+      }
+    }
+  }
+  assert(accepted == n);
+  assert(!board.is_pseudo_legal(Move()));
+}
+
 int main () {
+  Bitboards::init_magic_tables();
+  // Castling, promotions and en passant all show up within 3 plies here
+  check_key_after(FEN::parse("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -"), 3);
+  check_key_after(FEN::parse("n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1"), 3);
+
+  // Discovered checks, en passant and castling into check included
+  check_checks(FEN::parse("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -"), 3);
+  check_checks(FEN::parse("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -"), 4);
+  check_checks(FEN::parse("5k2/8/8/8/8/8/8/4K2R w K -"), 2);
+  std::ifstream list("resources/perft_test_list.txt");
+  std::string line;
+  while (std::getline(list, line))
+    if (!line.empty()) {
+      const Board board = FEN::parse(line.substr(0, line.find(';')));
+      check_checks(board, 2);
+      check_pseudo_legal(board);
+      std::array<Move, MAX_MOVES> moves;
+      const size_t n = MoveGen::generate_all(board, moves);
+      for (size_t i = 0; i < n; ++i) {
+        Board child = board;
+        child.makeMove(moves[i]);
+        check_pseudo_legal(child);
+      }
+    }
+
   std::string startFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -";
   Board board = FEN::parse(startFEN);
 
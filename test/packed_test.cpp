@@ -0,0 +1,128 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "packed.h"
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fen.h"
+#include "magic.h"
+#include "movegen.h"
+#include "zobrist.h"
+
+namespace {
+
+void check_round_trip(const Board& board) {
+  const PackedBoard p =
+      PackedBoard::encode(board, -123, Move(E2, E4), PackedBoard::RESULT_WIN, 57);
+  const Board back = p.decode();
+  assert(FEN::to_fen(back) == FEN::to_fen(board));
+  assert(back.hash == board.hash);
+  assert(back.halfMoveClock == board.halfMoveClock);
+  assert(p.fullmove == 57);
+  assert(p.score == -123);
+  assert(p.move == Move(E2, E4));
+  assert(p.result() == PackedBoard::RESULT_WIN);
+}
+
+}  // namespace
+
+int main() {
+  Zobrist::init_zobrist_keys();
+  Bitboards::init_magic_tables();
+
+  std::vector<Board> boards;
+  for (const char* path : {"resources/bench_fen_list.txt", "resources/perft_test_list.txt"}) {
+    std::ifstream in(path);
+    assert(in);
+    std::string line;
+    while (std::getline(in, line))
+      if (!line.empty()) boards.push_back(FEN::parse(line.substr(0, line.find(';'))));
+  }
+
+  // Counters, castling with the rook on its square and en passant files
+  boards.push_back(FEN::parse("r3k2r/8/8/8/8/8/8/R3K2R b Kq - 37 112"));
+  boards.push_back(FEN::parse("rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3"));
+  boards.push_back(FEN::parse("rnbqkbnr/pppp1ppp/8/8/3Pp3/8/PPP1PPPP/RNBQKBNR b KQkq d3 0 2"));
+
+  // Random playouts reach positions with lost rights and fresh ep squares
+  std::mt19937_64 rng(42);
+  const size_t seeds = boards.size();
+  for (size_t i = 0; i < seeds; ++i) {
+    Board b = boards[i];
+    for (int ply = 0; ply < 60; ++ply) {
+      std::array<Move, MAX_MOVES> moves;
+      const size_t n = MoveGen::generate_all(b, moves);
+      if (n == 0) break;
+      b.makeMove(moves[rng() % n]);
+      boards.push_back(b);
+    }
+  }
+
+  for (const Board& b : boards) check_round_trip(b);
+  std::cout << boards.size() << " positions round trip\n";
+
+  // Write a file and read it back through the mapping
+  const auto path = std::filesystem::temp_directory_path() / "fochess_packed_test.bin";
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    for (size_t i = 0; i < boards.size(); ++i) {
+      const PackedBoard p = PackedBoard::encode(boards[i], static_cast<int16_t>(i));
+      out.write(reinterpret_cast<const char*>(&p), sizeof(p));
+    }
+  }
+
+  PackedReader reader;
+  assert(!reader.open((path.string() + ".missing")));
+  assert(reader.open(path.string()));
+  assert(reader.size() == boards.size());
+  size_t i = 0;
+  for (const PackedBoard& p : reader) {
+    assert(p.score == static_cast<int16_t>(i));
+    assert(p.result() == PackedBoard::RESULT_NONE);
+    assert(p.decode().hash == boards[i].hash);
+    ++i;
+  }
+  assert(i == boards.size());
+  reader.close();
+  assert(reader.size() == 0);
+
+  // Decoding a record against parsing its FEN
+  std::vector<std::string> fens;
+  std::vector<PackedBoard> packed;
+  for (const Board& b : boards) {
+    fens.push_back(FEN::to_fen(b));
+    packed.push_back(PackedBoard::encode(b));
+  }
+
+  constexpr int ROUNDS = 20;
+  uint64_t sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; ++r)
+    for (const std::string& fen : fens) sink ^= FEN::parse(fen).hash;
+  auto t1 = std::chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; ++r)
+    for (const PackedBoard& p : packed) sink ^= p.decode().hash;
+  auto t2 = std::chrono::steady_clock::now();
+
+  const double n = static_cast<double>(ROUNDS) * static_cast<double>(boards.size());
+  std::cout << "FEN parse   " << n / std::chrono::duration<double>(t1 - t0).count() << " pos/s\n";
+  std::cout << "packed read " << n / std::chrono::duration<double>(t2 - t1).count() << " pos/s\n";
+  std::cout << "(" << sink % 2 << ")\n";
+
+  std::filesystem::remove(path);
+  std::cout << "Packed tests passed\n";
+  return 0;
+}
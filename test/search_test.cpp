@@ -29,10 +29,7 @@ int main() {
   board.makeMove(FoChess::g_search_stats.best_move.load());
 
   std::chrono::duration<double> elapsed = end - start;
-#ifdef DEBUG
-  std::cout << "tt hits: " << tt.hits << "\n";
-  tt.hits = 0;
-#endif
+  std::cout << FoChess::g_search_stats.snapshot().to_info_string();
   std::cout << "best move and score: "
             << PrintingHelpers::move_to_str(
                    FoChess::g_search_stats.best_move.load())
@@ -0,0 +1,205 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "tablebase.h"
+
+#include <cassert>
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+#include "fen.h"
+#include "helpers.h"
+#include "magic.h"
+#include "search.h"
+#include "tablebase_gen.h"
+#include "tt.h"
+#include "zobrist.h"
+
+using Tablebases::WDL;
+
+namespace {
+
+WDL wdl_of(const Board& board) {
+  WDL wdl = Tablebases::WDL_DRAW;
+  bool found = Tablebases::probe_wdl(board, wdl);
+  assert(found);
+  (void)found;
+  return wdl;
+}
+
+WDL wdl_of(const std::string& fen) { return wdl_of(FEN::parse(fen)); }
+
+int dtz_of(const Board& board) {
+  int dtz = 0;
+  bool found = Tablebases::probe_dtz(board, dtz);
+  assert(found);
+  (void)found;
+  return dtz;
+}
+
+bool is_zeroing(const Board& board, Move m) {
+  return m.type() == EN_PASSANT || (board.allPieces() & Bitboards::square_bb(m.to_sq())) ||
+         (board.pieces(board.sideToMove, PAWN) & Bitboards::square_bb(m.from_sq()));
+}
+
+// The stored WDL is the best result over the moves, the stored DTZ the
+// shortest win (longest loss) over them
+void check_consistency(const Board& board) {
+  const WDL root = wdl_of(board);
+  const int root_dtz = dtz_of(board);
+
+  std::array<Move, MAX_MOVES> moves;
+  size_t n = MoveGen::generate_all(board, moves);
+  if (n == 0) {
+    assert(root == (board.checkers ? Tablebases::WDL_LOSS : Tablebases::WDL_DRAW));
+    return;
+  }
+
+  int best = Tablebases::WDL_LOSS, shortest_win = 1000, longest_loss = 0;
+  for (size_t i = 0; i < n; ++i) {
+    Board child = board;
+    child.makeMove(moves[i]);
+    const WDL w = wdl_of(child);
+    best = std::max(best, -static_cast<int>(w));
+
+    const bool zeroing = is_zeroing(board, moves[i]);
+    std::array<Move, MAX_MOVES> replies;
+    if (w == Tablebases::WDL_LOSS) {
+      const bool mated = MoveGen::generate_all(child, replies) == 0;
+      shortest_win = std::min(shortest_win, zeroing || mated ? 1 : 1 - dtz_of(child));
+    }
+    if (w == Tablebases::WDL_WIN)
+      longest_loss = std::max(longest_loss, zeroing ? 1 : dtz_of(child) + 1);
+  }
+  assert(best == root);
+  if (root == Tablebases::WDL_WIN) assert(root_dtz == shortest_win);
+  if (root == Tablebases::WDL_LOSS) assert(root_dtz == -longest_loss);
+}
+
+}  // namespace
+
+int main() {
+  Zobrist::init_zobrist_keys();
+  Bitboards::init_magic_tables();
+
+  // Table scores stay relative to the node in the hash table
+  static_assert(FoChess::score_from_tt(FoChess::score_to_tt(FoChess::TB_WIN_SCORE - 5, 3), 7) ==
+                FoChess::TB_WIN_SCORE - 9);
+  static_assert(FoChess::score_from_tt(FoChess::score_to_tt(-FoChess::TB_WIN_SCORE + 5, 3), 7) ==
+                -FoChess::TB_WIN_SCORE + 9);
+
+  // Real Syzygy files cannot be fetched here, the generator writes the
+  // same format. The published figures below pin the results.
+  const std::string dir = (std::filesystem::temp_directory_path() / "fochess_tb_test").string();
+  std::filesystem::remove_all(dir);
+  assert(Tablebases::generate("KQvK", dir));
+  assert(Tablebases::generate("KRvK", dir));
+  assert(Tablebases::generate("KPvK", dir));
+
+  // A fresh process only sees the files, KBvK and KNvK came with KPvK
+  assert(Tablebases::init(dir) == 5);
+  assert(Tablebases::max_pieces() == 3);
+  assert(std::filesystem::exists(dir + "/KPvK.rtbz"));
+
+  // Mate in one with the rook, either colour
+  assert(wdl_of("k7/8/1K6/8/8/8/8/7R w - - 0 1") == Tablebases::WDL_WIN);
+  assert(dtz_of(FEN::parse("k7/8/1K6/8/8/8/8/7R w - - 0 1")) == 1);
+  assert(wdl_of("7r/8/8/8/8/1k6/8/K7 b - - 0 1") == Tablebases::WDL_WIN);
+  assert(dtz_of(FEN::parse("7r/8/8/8/8/1k6/8/K7 b - - 0 1")) == 1);
+
+  // The hanging queen gets taken, stalemate is a draw
+  assert(wdl_of("8/8/8/8/8/8/1Qk5/7K b - - 0 1") == Tablebases::WDL_DRAW);
+  assert(wdl_of("8/8/8/8/8/8/1Q1k4/7K b - - 0 1") == Tablebases::WDL_LOSS);
+  assert(wdl_of("k7/2Q5/1K6/8/8/8/8/8 b - - 0 1") == Tablebases::WDL_DRAW);
+
+  // King in front of its pawn on the sixth wins, the rook pawn does not
+  assert(wdl_of("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1") == Tablebases::WDL_WIN);
+  assert(wdl_of("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1") == Tablebases::WDL_LOSS);
+  assert(wdl_of("k7/8/8/8/8/8/P7/K7 w - - 0 1") == Tablebases::WDL_DRAW);
+  assert(wdl_of("k7/p7/8/8/8/8/8/K7 b - - 0 1") == Tablebases::WDL_DRAW);
+  assert(wdl_of("8/8/8/4k3/8/8/8/4KB2 w - - 0 1") == Tablebases::WDL_DRAW);
+  assert(Tablebases::signature(FEN::parse("8/8/8/8/4p3/4k3/8/4K3 w - - 0 1")) == "KPvK");
+
+  // Published Syzygy maxima: the longest KQvK win is 19 plies to mate
+  // (mate in 10), the longest KRvK one 31 (mate in 16). The side to move
+  // loses at most one ply later.
+  for (const auto& [piece, longest] : {std::pair{QUEEN, 19}, std::pair{ROOK, 31}}) {
+    int win = 0, loss = 0;
+    for (int wk = 0; wk < 64; ++wk)
+      for (int bk = 0; bk < 64; ++bk)
+        for (int sq = 0; sq < 64; ++sq) {
+          if (wk == bk || sq == wk || sq == bk) continue;
+          for (const Color stm : {WHITE, BLACK}) {
+            Board pos;
+            pos.put_piece(WHITE, KING, Square(wk));
+            pos.put_piece(BLACK, KING, Square(bk));
+            pos.put_piece(WHITE, piece, Square(sq));
+            pos.sideToMove = stm;
+            pos.update_checkers();
+            if (pos.is_in_check(Color(BLACK - stm))) continue;
+            const int dtz = dtz_of(pos);
+            (stm == WHITE ? win : loss) = std::max(stm == WHITE ? win : loss, std::abs(dtz));
+          }
+        }
+    assert(win == longest && loss == longest + 1);
+  }
+
+  // Only the mate survives at the root
+  std::array<Move, MAX_MOVES> moves;
+  Board board = FEN::parse("k7/8/1K6/8/8/8/8/7R w - - 0 1");
+  size_t n = MoveGen::generate_all(board, moves);
+  assert(Tablebases::filter_root_moves(board, moves, n) == 1);
+  assert(PrintingHelpers::move_to_str(moves[0]) == "h1h8");
+
+  // Random placements agree with their children
+  std::mt19937 rng(42);
+  for (const char piece : {'Q', 'R', 'B', 'N', 'P', 'q', 'r', 'p'}) {
+    int checked = 0;
+    while (checked < 1000) {
+      std::array<Square, 3> sq;
+      for (auto& s : sq) s = static_cast<Square>(rng() % 64);
+      if (sq[0] == sq[1] || sq[0] == sq[2] || sq[1] == sq[2]) continue;
+      if ((piece == 'P' || piece == 'p') && (sq[2] / 8 == 0 || sq[2] / 8 == 7)) continue;
+      std::string fen(64, '1');
+      fen[sq[0]] = 'K';
+      fen[sq[1]] = 'k';
+      fen[sq[2]] = piece;
+      std::string placement;
+      for (int row = 0; row < 8; ++row)
+        placement += fen.substr(static_cast<size_t>(row) * 8, 8) + (row < 7 ? "/" : "");
+      for (const char* stm : {" w - - 0 1", " b - - 0 1"}) {
+        Board pos = FEN::parse(placement + stm);
+        if (pos.is_in_check(Color(BLACK - pos.sideToMove))) continue;
+        check_consistency(pos);
+        ++checked;
+      }
+    }
+  }
+
+  // Winning the knight lands in a table the search probes
+  TranspositionTable tt(16);
+  board = FEN::parse("8/8/8/4k3/8/8/3n4/4K2R w - - 0 1");
+  FoChess::iterative_deepening(4, board, tt);
+  assert(FoChess::g_search_stats.best_root_score.load() >= FoChess::TB_WIN_SCORE - 4);
+  assert(FoChess::g_search_stats.tb_hits() > 0);
+
+  // In a table position the search only plays winning moves
+  board = FEN::parse("8/8/8/4k3/8/8/8/4K2R w - - 0 1");
+  FoChess::iterative_deepening(4, board, tt);
+  Board after = board;
+  after.makeMove(FoChess::g_search_stats.best_move.load());
+  assert(wdl_of(after) == Tablebases::WDL_LOSS);
+
+  Board mate = FEN::parse("k7/8/1K6/8/8/8/8/7R w - - 0 1");
+  FoChess::iterative_deepening(2, mate, tt);
+  assert(PrintingHelpers::move_to_str(FoChess::g_search_stats.best_move.load()) == "h1h8");
+
+  std::filesystem::remove_all(dir);
+  std::cout << "Tablebase test passed!\n";
+  return 0;
+}
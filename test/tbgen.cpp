@@ -0,0 +1,41 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+// Builds endgame tables: tbgen <dir> KQvK KRvK KPvK ...
+// Tables a signature converts into are built (or reused) first.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "magic.h"
+#include "tablebase_gen.h"
+#include "zobrist.h"
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "usage: tbgen <dir> <signature>...\n";
+    return 1;
+  }
+
+  Zobrist::init_zobrist_keys();
+  Bitboards::init_magic_tables();
+
+  const std::string dir = argv[1];
+  for (int i = 2; i < argc; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    if (!Tablebases::generate(argv[i], dir, &std::cout)) {
+      std::cerr << "failed to build " << argv[i] << "\n";
+      return 1;
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    std::cout << argv[i] << " done in " << ms << " ms\n";
+  }
+  return 0;
+}
@@ -1,16 +1,21 @@
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "board.h"
 #include "fen.h"
 #include "magic.h"
 #include "movegen.h"
+#include "thread.h"
 
 uint64_t perft(Board& board, int depth) {
   std::array<Move, MAX_MOVES> moves;
@@ -50,11 +55,19 @@ int main() {
   file.close();
 
   size_t total_lines = lines.size();
-  int lines_processed = 0;
+  std::atomic<size_t> lines_processed{0};
+  std::atomic<bool> failed{false};
+  std::mutex print_mutex;
+
+  size_t n_threads = std::max(1u, std::thread::hardware_concurrency());
+  ThreadPool pool(n_threads);
 
   auto total_start_time = std::chrono::high_resolution_clock::now();
 
-  for (const auto& current_line : lines) {
+  pool.parallel_for(total_lines, [&](size_t line_idx) {
+    if (failed.load(std::memory_order_relaxed)) return;
+
+    const std::string& current_line = lines[line_idx];
     std::stringstream ss(current_line);
     std::string fen;
     std::getline(ss, fen, ';');
@@ -75,6 +88,7 @@ int main() {
 
       uint64_t expected_nodes;
       if (!(segment_ss >> expected_nodes)) {
+        std::lock_guard<std::mutex> lock(print_mutex);
         std::cerr << "Could not parse expected nodes for token " << token
                   << " in line: " << current_line << std::endl;
         continue;
@@ -83,22 +97,27 @@ int main() {
       uint64_t result = perft(board, depth);
 
       if (result != expected_nodes) {
+        std::lock_guard<std::mutex> lock(print_mutex);
         std::cerr << "\n--- TEST FAILED ---\n";
         std::cerr << "FEN: " << fen << "\n";
         std::cerr << "Depth: " << depth << "\n";
         std::cerr << "given: " << result << ", expected: " << expected_nodes
                   << "\n";
         std::cerr << "-------------------\n";
-        return 1;
+        failed = true;
+        return;
       }
     }
 
-    lines_processed++;
-    int percentage = static_cast<int>((static_cast<double>(lines_processed) /
+    size_t done = ++lines_processed;
+    int percentage = static_cast<int>((static_cast<double>(done) /
                                        static_cast<double>(total_lines)) *
                                       100.0);
+    std::lock_guard<std::mutex> lock(print_mutex);
     std::cout << "[" << percentage << "% processed]\n";
-  }
+  });
+
+  if (failed) return 1;
 
   auto total_end_time = std::chrono::high_resolution_clock::now();
   auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -8,12 +8,14 @@
 #include "tt.h"
 
 #include <cassert>
+#include <cstdio>
 #include <iostream>
 
 #include "board.h"
 #include "fen.h"
 #include "helpers.h"
 #include "search.h"
+#include "thread.h"
 #include "zobrist.h"
 
 int main() {
@@ -21,8 +23,7 @@ int main() {
 
   // Initial position
   Board board1 = FEN::parse("8/8/8/8/8/8/8/k1K5 w - - 0 1");
-  board1.pieces[WHITE][KNIGHT] |= (1ULL << Square::G1);
-  board1.updateOccupancy();
+  board1.put_piece(WHITE, KNIGHT, Square::G1);
 
   // Position after g1-f3-g1
   Board board2 = board1;
@@ -49,6 +50,37 @@ int main() {
   assert(score1 == score2);
   assert(move1 == move2);
 
+  // Resizing drops the old entries and keeps a power of 2 table
+  assert(tt.resize(3));
+  assert(tt.size_mb() == 2);
+  assert((tt.entries() & (tt.entries() - 1)) == 0);
+  assert(tt.probe(Zobrist::generate_hash(board1)) == nullptr);
+
+  // Parallel clear covers the whole table, including the last slice
+  ThreadPool pool(3);
+  tt.store(tt.entries(), 1, Move(), 1, TT_EXACT);
+  tt.store(tt.entries() - 1, 1, Move(), 1, TT_EXACT);
+  tt.clear(pool);
+  assert(tt.probe(tt.entries()) == nullptr);
+  assert(tt.probe(tt.entries() - 1) == nullptr);
+
+  // Entries keep the static eval when given one
+  const uint64_t eval_key = Zobrist::generate_hash(board1);
+  tt.store(eval_key, 5, Move(), 0, TT_ALPHA, -321);
+  assert(tt.probe(eval_key) && tt.probe(eval_key)->eval == -321);
+  tt.store(eval_key, 5, Move(), 1, TT_ALPHA);
+  assert(tt.probe(eval_key)->eval == TT_NO_EVAL);
+
+  // A saved table comes back with the same size and entries
+  tt.store(42, 7, Move(), 3, TT_BETA);
+  assert(tt.save("tt_test.tt"));
+  TranspositionTable loaded(1);
+  assert(loaded.load("tt_test.tt"));
+  assert(loaded.entries() == tt.entries());
+  TTEntry* saved = loaded.probe(42);
+  assert(saved && saved->score == 7 && saved->depth == 3 && saved->flag == TT_BETA);
+  std::remove("tt_test.tt");
+
   std::cout << "Transposition table test passed!\n";
 
   return 0;
@@ -0,0 +1,87 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+// Tunes the evaluation tables on labelled positions:
+//   tune <data> [--epochs N] [--lr X] [--k K] [--lambda L] [--threads N]
+//        [--out eval_tables.h]
+// data is datagen output, text or --packed (.bin). The tables are written
+// every 100 epochs and at the end; copy the result over src/eval_tables.h.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "magic.h"
+#include "thread.h"
+#include "tune.h"
+#include "zobrist.h"
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: tune <data> [--epochs N] [--lr X] [--k K] [--lambda L] [--threads N]"
+                 " [--out file]\n";
+    return 1;
+  }
+
+  Tuner::Options options;
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  std::string out_file = "eval_tables.h";
+  for (int i = 2; i + 1 < argc; i += 2) {
+    const std::string arg = argv[i];
+    const char* value = argv[i + 1];
+    if (arg == "--epochs") options.epochs = std::atoi(value);
+    else if (arg == "--lr") options.lr = std::atof(value);
+    else if (arg == "--k") options.k = std::atof(value);
+    else if (arg == "--lambda") options.lambda = std::atof(value);
+    else if (arg == "--threads") threads = std::max<size_t>(1, std::strtoull(value, nullptr, 10));
+    else if (arg == "--out") out_file = value;
+  }
+
+  Zobrist::init_zobrist_keys();
+  Bitboards::init_magic_tables();
+  ThreadPool pool(threads);
+
+  auto start = std::chrono::steady_clock::now();
+  auto elapsed = [&] {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  Tuner::Dataset data;
+  if (!Tuner::load(argv[1], data, pool) || data.size() == 0) {
+    std::cerr << "no positions in " << argv[1] << "\n";
+    return 1;
+  }
+  std::cout << "loaded " << data.size() << " positions in " << elapsed() << " s" << std::endl;
+
+  Tuner::Params params = Tuner::current_params();
+  if (options.k <= 0) {
+    options.k = Tuner::fit_k(data, params, options.lambda, pool);
+    std::cout << "k " << options.k << std::endl;
+  }
+
+  auto save = [&] {
+    std::ofstream out(out_file);
+    out << Tuner::to_header(params);
+  };
+
+  start = std::chrono::steady_clock::now();
+  Tuner::tune(data, params, options, pool, [&](int epoch, double loss) {
+    if (epoch == 1 || epoch % 10 == 0)
+      std::cout << "epoch " << epoch << " loss " << loss << " (" << elapsed() / epoch
+                << " s/epoch)" << std::endl;
+    if (epoch % 100 == 0) save();
+  });
+  save();
+
+  std::cout << "final loss " << Tuner::loss(data, params, options.k, options.lambda, pool)
+            << ", tables written to " << out_file << "\n";
+  return 0;
+}
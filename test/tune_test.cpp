@@ -0,0 +1,140 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "tune.h"
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "evaluate.h"
+#include "fen.h"
+#include "magic.h"
+#include "movegen.h"
+#include "packed.h"
+#include "zobrist.h"
+
+int main() {
+  Zobrist::init_zobrist_keys();
+  Bitboards::init_magic_tables();
+
+  // The generated header is exactly what the engine is built with
+  {
+    std::ifstream in("src/eval_tables.h");
+    assert(in);
+    const std::string header{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    assert(Tuner::to_header(Tuner::current_params()) == header);
+  }
+
+  std::vector<Board> boards;
+  for (const char* path : {"resources/bench_fen_list.txt", "resources/perft_test_list.txt"}) {
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line))
+      if (!line.empty()) boards.push_back(FEN::parse(line.substr(0, line.find(';'))));
+  }
+  std::mt19937_64 rng(7);
+  const size_t seeds = boards.size();
+  for (size_t i = 0; i < seeds; ++i) {
+    Board b = boards[i];
+    for (int ply = 0; ply < 80; ++ply) {
+      std::array<Move, MAX_MOVES> moves;
+      const size_t n = MoveGen::generate_all(b, moves);
+      if (n == 0) break;
+      b.makeMove(moves[rng() % n]);
+      boards.push_back(b);
+    }
+  }
+
+  // Coefficients reproduce bland_evaluate
+  const Tuner::Params params = Tuner::current_params();
+  size_t linear = 0;
+  for (const Board& b : boards) {
+    std::vector<uint16_t> coeffs;
+    if (!Tuner::extract(b, coeffs)) continue;
+    const int eval = FoChess::bland_evaluate(b);
+    const int white = b.sideToMove == WHITE ? eval : -eval;
+    assert(Tuner::linear_eval(params, coeffs.data(), coeffs.data() + coeffs.size()) == white);
+    ++linear;
+  }
+  std::vector<uint16_t> kpk;
+  assert(!Tuner::extract(FEN::parse("8/8/8/4k3/8/4P3/4K3/8 w - -"), kpk));
+  std::cout << linear << " positions match bland_evaluate\n";
+
+  // Scores from the same tables with a cheaper knight: tuning on them alone
+  // (lambda 0) must find the knight value again
+  Tuner::Params target = params;
+  target[KNIGHT] = 400;
+  const auto dir = std::filesystem::temp_directory_path();
+  const auto text_path = dir / "fochess_tune_test.txt";
+  const auto packed_path = dir / "fochess_tune_test.bin";
+  {
+    std::ofstream text(text_path), packed(packed_path, std::ios::binary);
+    for (const Board& b : boards) {
+      std::vector<uint16_t> coeffs;
+      if (!Tuner::extract(b, coeffs)) continue;
+      const int score = static_cast<int>(
+          std::lround(Tuner::linear_eval(target, coeffs.data(), coeffs.data() + coeffs.size())));
+      text << FEN::to_fen(b) << " 0 1 | " << score << " | 0.5\n";
+      const PackedBoard p = PackedBoard::encode(b, static_cast<int16_t>(score), Move(),
+                                                PackedBoard::RESULT_DRAW);
+      packed.write(reinterpret_cast<const char*>(&p), sizeof(p));
+    }
+  }
+
+  ThreadPool pool(4);
+  Tuner::Dataset text_data, packed_data;
+  assert(Tuner::load(text_path.string(), text_data, pool));
+  assert(Tuner::load(packed_path.string(), packed_data, pool));
+  assert(text_data.size() == linear && packed_data.size() == linear);
+  assert(text_data.shards.size() == 4);
+  assert(std::abs(Tuner::loss(text_data, params, 1.0, 0.0, pool) -
+                  Tuner::loss(packed_data, params, 1.0, 0.0, pool)) < 1e-9);
+
+  Tuner::Options options;
+  options.epochs = 300;
+  options.lr = 2.0;
+  options.k = 1.0;
+  options.lambda = 0.0;
+  Tuner::Params tuned = params;
+  const double before = Tuner::loss(text_data, tuned, options.k, options.lambda, pool);
+  const auto t0 = std::chrono::steady_clock::now();
+  Tuner::tune(text_data, tuned, options, pool, nullptr);
+  const auto t1 = std::chrono::steady_clock::now();
+  const double after = Tuner::loss(text_data, tuned, options.k, options.lambda, pool);
+  // Values and tables only matter summed, compare knights where they stood
+  auto knights = [&](const Tuner::Params& p) {
+    double sum = 0, count = 0;
+    for (const Tuner::Shard& shard : text_data.shards)
+      for (uint16_t c : shard.coeffs)
+        if ((c & Tuner::INDEX_MASK) / 64 == KNIGHT)
+          sum += p[KNIGHT] + p[Tuner::NUM_PIECES + (c & Tuner::INDEX_MASK)], ++count;
+    return sum / count;
+  };
+  std::cout << "loss " << before << " -> " << after << ", knights " << knights(params) << " -> "
+            << knights(tuned) << " (" << knights(target) << "), "
+            << std::chrono::duration<double, std::milli>(t1 - t0).count() / options.epochs
+            << " ms/epoch\n";
+  assert(after < before / 10);
+  assert(std::abs(knights(tuned) - knights(target)) < std::abs(knights(params) - knights(target)) / 4);
+
+  const double k = Tuner::fit_k(text_data, params, 1.0, pool);
+  assert(k > 0);
+
+  std::filesystem::remove(text_path);
+  std::filesystem::remove(packed_path);
+  std::cout << "Tuner tests passed\n";
+  return 0;
+}
@@ -5,6 +5,7 @@
 //  Read the LICENSE file in the project root please.
 // -----------------------------------------------------------------------------
 
+#include "bitbase.h"
 #include "magic.h"
 #include "uci.h"
 #include "zobrist.h"
@@ -12,6 +13,7 @@
 int main (/*int argc, char *argv[]*/) {
   Zobrist::init_zobrist_keys();
   Bitboards::init_magic_tables();
+  Bitbases::init();
   UCIengine engine; engine.loop();
   return 0;
 }
@@ -0,0 +1,732 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#include "tablebase_gen.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bitboard.h"
+#include "magic.h"
+#include "syzygy.h"
+#include "types.h"
+
+namespace Tablebases {
+
+namespace {
+
+using Syzygy::Material;
+
+constexpr int MAX_GENERATED_PIECES = 4;
+
+// Plies to zeroing while generating, positive when the side to move wins
+constexpr int16_t V_INVALID = INT16_MIN;
+constexpr int16_t V_UNKNOWN = INT16_MIN + 1;
+constexpr int16_t V_MATED = INT16_MIN + 2;
+
+WDL wdl_of(int v) {
+  if (v == V_MATED) return WDL_LOSS;
+  if (v > 0) return v <= 100 ? WDL_WIN : WDL_CURSED_WIN;
+  if (v < 0) return v >= -100 ? WDL_LOSS : WDL_BLESSED_LOSS;
+  return WDL_DRAW;
+}
+
+// Plies as the DTZ file stores them: exact up to 100, in moves beyond
+// where the 50-move rule has the last word anyway
+int dtz_value(int v) {
+  const int d = v == V_MATED ? 1 : std::abs(v);
+  return d <= 100 ? d - 1 : (d - 101) / 2;
+}
+
+struct PieceSpec {
+  Color color;
+  Piece piece;
+};
+
+// Squares a piece of the side that just moved may have come from, with a
+// quiet move. Pawn moves zero the counter and are seeded instead.
+Bitboard unmove_targets(Piece piece, Square sq, Bitboard occ) {
+  switch (piece) {
+    case KNIGHT:
+      return Bitboards::knight_attacks(sq) & ~occ;
+    case BISHOP:
+      return Bitboards::bishop_attacks(sq, occ) & ~occ;
+    case ROOK:
+      return Bitboards::rook_attacks(sq, occ) & ~occ;
+    case QUEEN:
+      return (Bitboards::bishop_attacks(sq, occ) | Bitboards::rook_attacks(sq, occ)) & ~occ;
+    case KING:
+      return Bitboards::king_attacks(sq) & ~occ;
+    default:
+      return 0;
+  }
+}
+
+bool is_capture(const Board& board, Move m) {
+  return m.type() == EN_PASSANT || (board.allPieces() & Bitboards::square_bb(m.to_sq()));
+}
+
+bool is_zeroing(const Board& board, Move m) {
+  return is_capture(board, m) ||
+         (board.pieces(board.sideToMove, PAWN) & Bitboards::square_bb(m.from_sq()));
+}
+
+// Result of a position in another table, KvK has none
+bool other_table(const Board& board, WDL& wdl) {
+  if (Bitboards::popcount(board.allPieces()) == 2) {
+    wdl = WDL_DRAW;
+    return true;
+  }
+  return probe_wdl(board, wdl);
+}
+
+// Retrograde analysis of one table. Positions are indexed naively, one
+// square per piece and the side to move, pawns most significant: every
+// pawn placement is a slice that quiet moves never leave, and slices
+// are solved with the pawns furthest advanced first, so a pawn push
+// always lands in a solved one.
+class Generator {
+ public:
+  explicit Generator(const Material& material) : m(material) {
+    for (int c = WHITE; c <= BLACK; ++c)
+      for (int i = 0; i < m.counts[c][PAWN]; ++i) layout.push_back({Color(c), PAWN});
+    pawns = static_cast<int>(layout.size());
+    for (int c = WHITE; c <= BLACK; ++c)
+      for (int pt = KING; pt > PAWN; --pt)
+        for (int i = 0; i < m.counts[c][pt]; ++i) layout.push_back({Color(c), Piece(pt)});
+    n = static_cast<int>(layout.size());
+    slice_bits = 6 * (n - pawns) + 1;
+  }
+
+  bool solve() {
+    values.assign(size_t(2) << (6 * n), V_INVALID);
+
+    std::vector<std::pair<int, size_t>> slices;  // advancement, slice
+    for (size_t s = 0; s < (size_t(1) << (6 * pawns)); ++s) {
+      int advancement = 0;
+      Bitboard taken = 0;
+      bool valid = true;
+      for (int i = 0; i < pawns; ++i) {
+        const Square sq = Square((s >> (6 * (pawns - 1 - i))) & 63);
+        const int row = sq / 8;
+        valid &= row != 0 && row != 7 && !(taken & Bitboards::square_bb(sq));
+        taken |= Bitboards::square_bb(sq);
+        advancement += layout[size_t(i)].color == WHITE ? 7 - row : row;
+      }
+      if (valid) slices.emplace_back(advancement, s);
+    }
+    std::stable_sort(slices.begin(), slices.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    for (const auto& [advancement, s] : slices)
+      if (!solve_slice(s)) return false;
+    return true;
+  }
+
+  const Material& material() const { return m; }
+  const std::vector<int16_t>& results() const { return values; }
+
+  // False for overlapping pieces and pawns on the last ranks
+  bool decode(size_t idx, std::array<Square, Syzygy::MAX_PIECES>& squares, Color& stm) const {
+    stm = Color(idx & 1);
+    Bitboard taken = 0;
+    bool valid = true;
+    for (int i = n; i-- > 0;) {
+      idx >>= i == n - 1 ? 1 : 6;
+      squares[size_t(i)] = Square(idx & 63);
+      const Bitboard bb = Bitboards::square_bb(squares[size_t(i)]);
+      valid &= !(taken & bb);
+      if (layout[size_t(i)].piece == PAWN)
+        valid &= squares[size_t(i)] / 8 != 0 && squares[size_t(i)] / 8 != 7;
+      taken |= bb;
+    }
+    return valid;
+  }
+
+  Board board_of(const std::array<Square, Syzygy::MAX_PIECES>& squares, Color stm) const {
+    Board board;
+    for (int i = 0; i < n; ++i)
+      board.put_piece(layout[size_t(i)].color, layout[size_t(i)].piece, squares[size_t(i)]);
+    board.sideToMove = stm;
+    board.update_checkers();
+    board.hash = 0;
+    return board;
+  }
+
+ private:
+  size_t shift(int i) const { return static_cast<size_t>(6 * (n - 1 - i) + 1); }
+
+  size_t index_of(const Board& board) const {
+    size_t idx = static_cast<size_t>(board.sideToMove);
+    Bitboard taken = 0;
+    for (int i = 0; i < n; ++i) {
+      const PieceSpec& spec = layout[size_t(i)];
+      const Bitboard bb = board.pieces(spec.color, spec.piece) & ~taken;
+      const Square sq = Square(__builtin_ctzll(bb));
+      taken |= Bitboards::square_bb(sq);
+      idx |= size_t(sq) << shift(i);
+    }
+    return idx;
+  }
+
+  // Result after a pawn push of this table: the solved value, unless a
+  // capture does better (en passant is never stored)
+  bool pushed(const Board& board, WDL& wdl) const {
+    std::array<Move, MAX_MOVES> moves;
+    const size_t total = MoveGen::generate_all(board, moves);
+    int best = WDL_LOSS;
+    size_t captures = 0;
+    for (size_t i = 0; i < total; ++i) {
+      if (!is_capture(board, moves[i])) continue;
+      ++captures;
+      Board child = board;
+      child.makeMove(moves[i]);
+      WDL w;
+      if (!other_table(child, w)) return false;
+      best = std::max(best, -int(w));
+    }
+    if (!captures || captures < total) best = std::max(best, int(wdl_of(values[index_of(board)])));
+    wdl = WDL(best);
+    return true;
+  }
+
+  bool solve_slice(size_t slice) {
+    enum : uint8_t { DRAW_EXIT = 1, CURSED_EXIT = 2, LOSS_1 = 4, LOSS_101 = 8 };
+
+    const size_t base = slice << slice_bits, size = size_t(1) << slice_bits;
+    std::vector<uint8_t> pending(size, 0), exits(size, 0);
+    std::vector<std::vector<uint32_t>> buckets;  // by distance
+    std::vector<uint32_t> cursed;
+    auto push = [&](size_t local, int distance) {
+      if (buckets.size() <= size_t(distance)) buckets.resize(size_t(distance) + 1);
+      buckets[size_t(distance)].push_back(static_cast<uint32_t>(local));
+    };
+
+    std::array<Square, Syzygy::MAX_PIECES> squares;
+    std::array<Move, MAX_MOVES> moves;
+    for (size_t local = 0; local < size; ++local) {
+      Color stm;
+      if (!decode(base | local, squares, stm)) continue;
+      const Board board = board_of(squares, stm);
+      if (board.is_in_check(Color(BLACK - stm))) continue;
+
+      int16_t& v = values[base | local];
+      const size_t count = MoveGen::generate_all(board, moves);
+      if (count == 0) {
+        v = board.checkers ? V_MATED : 0;
+        if (board.checkers) push(local, 0);
+        continue;
+      }
+
+      // Captures and pawn moves lead to solved positions, quiet moves
+      // are left to the retrograde pass
+      bool win = false;
+      uint8_t quiet = 0, flags = 0;
+      for (size_t i = 0; i < count; ++i) {
+        const Move move = moves[i];
+        if (!is_zeroing(board, move)) {
+          ++quiet;
+          continue;
+        }
+        Board child = board;
+        child.makeMove(move);
+        const bool same_table = move.type() == NORMAL && child.captured_piece == NO_PIECE;
+        WDL w;
+        if (!(same_table ? pushed(child, w) : other_table(child, w))) return false;
+        switch (-w) {
+          case WDL_WIN: win = true; break;
+          case WDL_CURSED_WIN: flags |= CURSED_EXIT; break;
+          case WDL_DRAW: flags |= DRAW_EXIT; break;
+          case WDL_BLESSED_LOSS: flags |= LOSS_101; break;
+          default: flags |= LOSS_1; break;
+        }
+      }
+
+      if (win) {
+        v = 1;
+      } else if (quiet == 0) {
+        v = flags & CURSED_EXIT ? 101 : flags & DRAW_EXIT ? 0 : flags & LOSS_101 ? -101 : -1;
+      } else {
+        v = V_UNKNOWN;
+        pending[local] = quiet;
+        exits[local] = flags;
+        if (flags & CURSED_EXIT) cursed.push_back(static_cast<uint32_t>(local));
+        continue;
+      }
+      if (v) push(local, std::abs(v));
+    }
+
+    // A lost position makes every predecessor a win, a won one makes a
+    // predecessor lost once all of its quiet moves are wins for the
+    // opponent and it has no better exit. Distances are handled in
+    // increasing order: the first win found is the shortest, the last
+    // move to resolve a loss the longest.
+    for (size_t level = 0; level < buckets.size() || (level <= 101 && !cursed.empty()); ++level) {
+      if (level == 101)
+        for (uint32_t local : cursed)
+          if (values[base | local] == V_UNKNOWN) {
+            values[base | local] = 101;
+            push(local, 101);
+          }
+      if (level >= buckets.size()) continue;
+
+      for (size_t k = 0; k < buckets[level].size(); ++k) {
+        const size_t local = buckets[level][k];
+        const int v = values[base | local];
+        const int distance = v == V_MATED ? 0 : std::abs(v);
+
+        Color stm;
+        decode(base | local, squares, stm);
+        const Color mover = Color(BLACK - stm);
+        Bitboard occ = 0;
+        for (int i = 0; i < n; ++i) occ |= Bitboards::square_bb(squares[size_t(i)]);
+
+        for (int i = pawns; i < n; ++i) {
+          if (layout[size_t(i)].color != mover) continue;
+          const size_t without = (local ^ 1) & ~(size_t(63) << shift(i));
+          Bitboard from = unmove_targets(layout[size_t(i)].piece, squares[size_t(i)], occ);
+          while (from) {
+            const size_t prev = without | size_t(Bitboards::pop_lsb(from)) << shift(i);
+            int16_t& pv = values[base | prev];
+            if (pv != V_UNKNOWN) continue;
+
+            if (v < 0) {
+              pv = static_cast<int16_t>(distance + 1);
+              push(prev, distance + 1);
+            } else if (--pending[prev] == 0 && !(exits[prev] & (DRAW_EXIT | CURSED_EXIT))) {
+              const int loss = std::max(distance + 1, exits[prev] & LOSS_101 ? 101
+                                                      : exits[prev] & LOSS_1 ? 1
+                                                                             : 0);
+              pv = static_cast<int16_t>(-loss);
+              push(prev, loss);
+            }
+          }
+        }
+      }
+      std::vector<uint32_t>().swap(buckets[level]);
+    }
+
+    for (size_t local = 0; local < size; ++local)
+      if (values[base | local] == V_UNKNOWN) values[base | local] = 0;
+    return true;
+  }
+
+  Material m;
+  std::vector<PieceSpec> layout;
+  int n = 0, pawns = 0, slice_bits = 0;
+  std::vector<int16_t> values;
+};
+
+// ---------------------------------------------------------------------------
+// Writing the files
+
+constexpr size_t BLOCK_BITS = 6;  // 64 byte blocks
+constexpr size_t MAX_SYMBOLS = 512;
+constexpr uint32_t MIN_PAIR_COUNT = 8;
+constexpr int MAX_CODE_LENGTH = 32;
+
+void put16(std::vector<uint8_t>& out, size_t v) {
+  out.push_back(static_cast<uint8_t>(v));
+  out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+void put32(std::vector<uint8_t>& out, size_t v) {
+  put16(out, v & 0xFFFF);
+  put16(out, v >> 16);
+}
+
+// One table of a file, in the pieces set() reads separately
+struct Encoded {
+  std::vector<uint8_t> sizes, sparse, lengths, blocks;
+};
+
+struct Symbol {
+  size_t left, right;  // right == LEAF: left is the value
+  size_t values;
+};
+constexpr size_t LEAF = 0xFFF;
+
+// Code lengths of a Huffman code over the used symbols, 0 for the others
+std::vector<int> code_lengths(std::vector<uint64_t> freq) {
+  std::vector<int> len(freq.size(), 0);
+  for (;;) {
+    using Node = std::pair<uint64_t, size_t>;
+    std::priority_queue<Node, std::vector<Node>, std::greater<Node>> heap;
+    std::vector<size_t> parent(freq.size(), SIZE_MAX);
+    for (size_t s = 0; s < freq.size(); ++s)
+      if (freq[s]) heap.push({freq[s], s});
+    if (heap.size() == 1) {
+      len[heap.top().second] = 1;
+      return len;
+    }
+    while (heap.size() > 1) {
+      const Node a = heap.top();
+      heap.pop();
+      const Node b = heap.top();
+      heap.pop();
+      parent.push_back(SIZE_MAX);
+      parent[a.second] = parent[b.second] = parent.size() - 1;
+      heap.push({a.first + b.first, parent.size() - 1});
+    }
+
+    int longest = 0;
+    for (size_t s = 0; s < freq.size(); ++s) {
+      len[s] = 0;
+      if (!freq[s]) continue;
+      for (size_t p = parent[s]; p != SIZE_MAX; p = parent[p]) ++len[s];
+      longest = std::max(longest, len[s]);
+    }
+    if (longest <= MAX_CODE_LENGTH) return len;
+    for (auto& f : freq)
+      if (f) f = (f + 1) / 2;  // flatter until it fits
+  }
+}
+
+// Compresses values (-1 where nobody probes) the way the files store
+// them: recursive pairing of the values into symbols, then a canonical
+// Huffman code with the longest codes numbered first
+Encoded compress(std::vector<int> values, uint8_t flags) {
+  Encoded e;
+
+  int last = 0;
+  for (int v : values)
+    if (v >= 0) {
+      last = v;
+      break;
+    }
+  for (int& v : values) v = v < 0 ? last : (last = v);
+
+  if (std::all_of(values.begin(), values.end(), [&](int v) { return v == values[0]; })) {
+    e.sizes = {static_cast<uint8_t>(flags | Syzygy::SINGLE_VALUE), static_cast<uint8_t>(values[0])};
+    return e;
+  }
+
+  std::vector<Symbol> symbols;
+  std::vector<size_t> leaf(size_t(*std::max_element(values.begin(), values.end())) + 1, SIZE_MAX);
+  std::vector<uint16_t> seq(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    size_t& s = leaf[size_t(values[i])];
+    if (s == SIZE_MAX) {
+      s = symbols.size();
+      symbols.push_back({size_t(values[i]), LEAF, 1});
+    }
+    seq[i] = static_cast<uint16_t>(s);
+  }
+
+  // Replace the most frequent pair by a new symbol, as long as it pays
+  std::vector<uint32_t> counts;
+  while (symbols.size() < MAX_SYMBOLS) {
+    const size_t n = symbols.size();
+    counts.assign(n * n, 0);
+    bool skip = false;
+    for (size_t i = 0; i + 1 < seq.size(); ++i) {
+      if (skip) {
+        skip = false;
+        continue;
+      }
+      ++counts[seq[i] * n + seq[i + 1]];
+      // "aaa" holds one "aa", not two
+      skip = seq[i] == seq[i + 1] && i + 2 < seq.size() && seq[i + 2] == seq[i];
+    }
+
+    size_t best = 0;
+    for (size_t p = 1; p < counts.size(); ++p)
+      if (counts[p] > counts[best] && symbols[p / n].values + symbols[p % n].values <= 256)
+        best = p;
+    if (counts[best] < MIN_PAIR_COUNT || symbols[best / n].values + symbols[best % n].values > 256)
+      break;
+
+    const size_t a = best / n, b = best % n;
+    symbols.push_back({a, b, symbols[a].values + symbols[b].values});
+    size_t out = 0;
+    for (size_t i = 0; i < seq.size();) {
+      if (i + 1 < seq.size() && seq[i] == a && seq[i + 1] == b) {
+        seq[out++] = static_cast<uint16_t>(n);
+        i += 2;
+      } else {
+        seq[out++] = seq[i++];
+      }
+    }
+    seq.resize(out);
+  }
+
+  std::vector<uint64_t> freq(symbols.size(), 0);
+  for (uint16_t s : seq) ++freq[s];
+  const std::vector<int> len = code_lengths(freq);
+
+  // Coded symbols first, longest codes lowest, then the ones only
+  // reached through pairs
+  std::vector<size_t> order(symbols.size());
+  for (size_t s = 0; s < order.size(); ++s) order[s] = s;
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    if ((len[a] > 0) != (len[b] > 0)) return len[a] > 0;
+    return len[a] > len[b];
+  });
+  std::vector<size_t> id(symbols.size());
+  for (size_t i = 0; i < order.size(); ++i) id[order[i]] = i;
+
+  int min_len = MAX_CODE_LENGTH, max_len = 0;
+  for (int l : len)
+    if (l) {
+      min_len = std::min(min_len, l);
+      max_len = std::max(max_len, l);
+    }
+  const size_t lengths = size_t(max_len - min_len) + 1;
+  std::vector<size_t> per_length(lengths, 0), lowest(lengths, 0);
+  std::vector<uint64_t> first(lengths, 0);
+  for (int l : len)
+    if (l) ++per_length[size_t(l - min_len)];
+  for (size_t i = lengths - 1; i-- > 0;) {
+    lowest[i] = lowest[i + 1] + per_length[i + 1];
+    first[i] = (first[i + 1] + per_length[i + 1]) / 2;
+  }
+  auto code_of = [&](size_t s) {
+    const size_t i = size_t(len[s] - min_len);
+    return first[i] + (id[s] - lowest[i]);
+  };
+
+  // Whole symbols per block, bits from the most significant one
+  const size_t block_size = size_t(1) << BLOCK_BITS;
+  std::vector<size_t> block_values;
+  std::vector<uint8_t> block(block_size, 0);
+  size_t bits = 0, in_block = 0;
+  auto flush = [&]() {
+    e.blocks.insert(e.blocks.end(), block.begin(), block.end());
+    std::fill(block.begin(), block.end(), 0);
+    block_values.push_back(in_block);
+    bits = in_block = 0;
+  };
+  for (uint16_t s : seq) {
+    const auto l = static_cast<size_t>(len[s]);
+    if (bits + l > 8 * block_size || in_block + symbols[s].values > 65536) flush();
+    const uint64_t code = code_of(s);
+    for (size_t b = l; b-- > 0; ++bits)
+      if ((code >> b) & 1) block[bits / 8] |= static_cast<uint8_t>(0x80 >> (bits % 8));
+    in_block += symbols[s].values;
+  }
+  flush();
+
+  // The sparse index points at the middle of every span, a span past
+  // the last value points into a padding block
+  const size_t num_blocks = block_values.size();
+  size_t span_bits = 0;
+  while ((size_t(2) << span_bits) <= values.size() / num_blocks && span_bits < 15) ++span_bits;
+  const size_t span = size_t(1) << span_bits;
+  std::vector<size_t> starts(num_blocks + 1, 0);
+  for (size_t b = 0; b < num_blocks; ++b) starts[b + 1] = starts[b] + block_values[b];
+
+  uint8_t padding = 0;
+  for (size_t k = 0; k * span < values.size(); ++k) {
+    const size_t ref = k * span + span / 2;
+    size_t b = num_blocks;
+    if (ref < values.size())
+      b = size_t(std::upper_bound(starts.begin(), starts.end(), ref) - starts.begin()) - 1;
+    else
+      padding = 1;
+    put32(e.sparse, b);
+    put16(e.sparse, ref - starts[b]);
+  }
+  for (size_t v : block_values) put16(e.lengths, v - 1);
+  if (padding) put16(e.lengths, 0xFFFF);
+
+  e.sizes.push_back(flags);
+  e.sizes.push_back(BLOCK_BITS);
+  e.sizes.push_back(static_cast<uint8_t>(span_bits));
+  e.sizes.push_back(padding);
+  put32(e.sizes, num_blocks);
+  e.sizes.push_back(static_cast<uint8_t>(max_len));
+  e.sizes.push_back(static_cast<uint8_t>(min_len));
+  for (size_t i = 0; i < lengths; ++i) put16(e.sizes, lowest[i]);
+  put16(e.sizes, symbols.size());
+  for (size_t s : order) {
+    const Symbol& sym = symbols[s];
+    const size_t left = sym.right == LEAF ? sym.left : id[sym.left];
+    const size_t right = sym.right == LEAF ? LEAF : id[sym.right];
+    e.sizes.push_back(static_cast<uint8_t>(left));
+    e.sizes.push_back(static_cast<uint8_t>((left >> 8) | (right & 0xF) << 4));
+    e.sizes.push_back(static_cast<uint8_t>(right >> 4));
+  }
+  if (symbols.size() & 1) e.sizes.push_back(0);
+  return e;
+}
+
+void align(std::vector<uint8_t>& out, size_t a) {
+  out.resize((out.size() + a - 1) / a * a, 0);
+}
+
+// tables[file][side], every file with the same pieces
+bool write_file(const std::string& path, const uint8_t magic[4], const Material& m,
+                const uint8_t* pieces, const std::vector<std::vector<Encoded>>& tables) {
+  const bool pp = m.hasPawns && m.pawnCount[1];
+  std::vector<uint8_t> out(magic, magic + 4);
+  out.push_back(static_cast<uint8_t>((m.key != m.key2 ? Syzygy::SPLIT : 0) |
+                                     (m.hasPawns ? Syzygy::HAS_PAWNS : 0)));
+  for (size_t f = 0; f < tables.size(); ++f) {
+    out.push_back(0x00);  // leading group first...
+    if (pp) out.push_back(0x11);  // ...then the other pawns
+    for (int k = 0; k < m.pieceCount; ++k)
+      out.push_back(static_cast<uint8_t>(pieces[k] | pieces[k] << 4));
+  }
+  align(out, 2);
+
+  for (const auto& file : tables)
+    for (const Encoded& e : file) out.insert(out.end(), e.sizes.begin(), e.sizes.end());
+  align(out, 2);
+  for (const auto& file : tables)
+    for (const Encoded& e : file) out.insert(out.end(), e.sparse.begin(), e.sparse.end());
+  for (const auto& file : tables)
+    for (const Encoded& e : file) out.insert(out.end(), e.lengths.begin(), e.lengths.end());
+  for (const auto& file : tables)
+    for (const Encoded& e : file) {
+      align(out, 64);
+      out.insert(out.end(), e.blocks.begin(), e.blocks.end());
+    }
+
+  // Real files end with a checksum, this one is left empty
+  align(out, 64);
+  out.resize(out.size() + 16, 0);
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+  return static_cast<bool>(file.flush());
+}
+
+// Maps the solved positions into the Syzygy index and writes the .rtbw
+// (both sides to move, unless symmetric) and .rtbz (white to move) files
+bool write_tables(const Generator& g, const std::string& base, size_t& positions) {
+  const Material& m = g.material();
+  const int files = m.hasPawns ? 4 : 1;
+  const int sides = m.key != m.key2 ? 2 : 1;
+
+  // Leading pawns, the other pawns, then the kings, then a unique piece
+  // so three of them can lead, then the rest by kind
+  std::vector<uint8_t> pieces;
+  if (m.hasPawns) {
+    const Color lead = m.leadColor, other = Color(BLACK - lead);
+    pieces.insert(pieces.end(), size_t(m.counts[lead][PAWN]), Syzygy::piece_code(lead, PAWN));
+    pieces.insert(pieces.end(), size_t(m.counts[other][PAWN]), Syzygy::piece_code(other, PAWN));
+  }
+  pieces.push_back(Syzygy::piece_code(WHITE, KING));
+  pieces.push_back(Syzygy::piece_code(BLACK, KING));
+  int counts[2][6];
+  std::copy(&m.counts[0][0], &m.counts[0][0] + 12, &counts[0][0]);
+  if (!m.hasPawns && m.hasUniquePieces)
+    for (int c = WHITE, done = 0; c <= BLACK && !done; ++c)
+      for (int pt = QUEEN; pt > PAWN && !done; --pt)
+        if (counts[c][pt] == 1) {
+          pieces.push_back(Syzygy::piece_code(Color(c), Piece(pt)));
+          counts[c][pt] = 0;
+          done = 1;
+        }
+  for (int c = WHITE; c <= BLACK; ++c)
+    for (int pt = QUEEN; pt > PAWN; --pt)
+      pieces.insert(pieces.end(), size_t(counts[c][pt]), Syzygy::piece_code(Color(c), Piece(pt)));
+
+  const int order[2] = {0, m.hasPawns && m.pawnCount[1] ? 1 : 0xF};
+  std::vector<Syzygy::Layout> layouts(static_cast<size_t>(files));
+  std::vector<std::vector<int>> wdl(static_cast<size_t>(files * sides)),
+      dtz(static_cast<size_t>(files));
+  for (size_t f = 0; f < layouts.size(); ++f) {
+    std::copy(pieces.begin(), pieces.end(), layouts[f].pieces);
+    const uint64_t size = Syzygy::set_groups(m, layouts[f], order, static_cast<int>(f));
+    for (int s = 0; s < sides; ++s) wdl[f * size_t(sides) + size_t(s)].assign(size, -1);
+    dtz[f].assign(size, -1);
+  }
+
+  positions = 0;
+  const std::vector<int16_t>& values = g.results();
+  std::array<Square, Syzygy::MAX_PIECES> squares;
+  for (size_t idx = 0; idx < values.size(); ++idx) {
+    const int v = values[idx];
+    if (v == V_INVALID) continue;
+    ++positions;
+
+    Color stm;
+    g.decode(idx, squares, stm);
+    Syzygy::Placement p;
+    Syzygy::place(m, g.board_of(squares, stm), p);
+    const auto f = static_cast<size_t>(p.file);
+    const uint64_t i = Syzygy::encode(m, layouts[f], p);
+    if (p.stm >= sides || i >= dtz[f].size()) return false;
+
+    // Equal positions (mirrors, swapped equal pieces) share an index
+    int& w = wdl[f * size_t(sides) + size_t(p.stm)][i];
+    if (w >= 0 && w != wdl_of(v) + 2) return false;
+    w = wdl_of(v) + 2;
+    if (p.stm == 0 && v != 0) {
+      int& d = dtz[f][i];
+      if (d >= 0 && d != dtz_value(v)) return false;
+      d = dtz_value(v);
+    }
+  }
+
+  std::vector<std::vector<Encoded>> wdl_tables(static_cast<size_t>(files)),
+      dtz_tables(static_cast<size_t>(files));
+  for (size_t f = 0; f < size_t(files); ++f) {
+    for (int s = 0; s < sides; ++s)
+      wdl_tables[f].push_back(compress(wdl[f * size_t(sides) + size_t(s)], 0));
+    dtz_tables[f].push_back(compress(dtz[f], Syzygy::WIN_PLIES | Syzygy::LOSS_PLIES));
+  }
+  return write_file(base + ".rtbw", Syzygy::WDL_MAGIC, m, pieces.data(), wdl_tables) &&
+         write_file(base + ".rtbz", Syzygy::DTZ_MAGIC, m, pieces.data(), dtz_tables);
+}
+
+bool build(const std::string& name, const std::string& dir, std::ostream* log) {
+  const std::string base = dir + "/" + name;
+  std::error_code ec;
+  if (std::filesystem::exists(base + ".rtbw", ec) && std::filesystem::exists(base + ".rtbz", ec))
+    return true;
+
+  Material m;
+  if (!Syzygy::parse_material(name, m) || m.pieceCount > MAX_GENERATED_PIECES) return false;
+
+  // Every table one capture or promotion away
+  for (int c = WHITE; c <= BLACK; ++c)
+    for (int pt = PAWN; pt < KING; ++pt) {
+      if (!m.counts[c][pt]) continue;
+      int less[2][6];
+      std::copy(&m.counts[0][0], &m.counts[0][0] + 12, &less[0][0]);
+      --less[c][pt];
+      if (m.pieceCount > 3 && !build(Syzygy::table_name(less), dir, log)) return false;
+      if (pt != PAWN) continue;
+      for (int promo = QUEEN; promo > PAWN; --promo) {
+        ++less[c][promo];
+        if (!build(Syzygy::table_name(less), dir, log)) return false;
+        --less[c][promo];
+      }
+    }
+  init(dir);
+
+  Generator g(m);
+  size_t positions = 0;
+  if (!g.solve() || !write_tables(g, base, positions)) return false;
+  if (log) *log << "built " << name << ", " << positions << " positions\n";
+  init(dir);
+  return true;
+}
+
+}  // namespace
+
+bool generate(const std::string& signature, const std::string& dir, std::ostream* log) {
+  Syzygy::Material m;
+  if (!Syzygy::parse_material(signature, m)) return false;
+  std::error_code ec;
+  std::filesystem::create_directories(dir, ec);
+  const bool ok = build(Syzygy::table_name(m.counts), dir, log);
+  init(dir);
+  return ok;
+}
+
+}  // namespace Tablebases
@@ -0,0 +1,28 @@
+// -----------------------------------------------------------------------------
+//  FoChess
+//  Copyright (c) 2025 Flavio Milinanni. All Rights Reserved.
+//
+//  Read the LICENSE file in the project root please.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include <ostream>
+#include <string>
+
+#include "tablebase.h"
+
+/**
+ * Builds small Syzygy tables by retrograde analysis, for tbgen and the
+ * tests. Not part of the engine: only the binaries that need it link it.
+ */
+namespace Tablebases {
+
+// Builds the table for signature into dir, first building every table it
+// converts into, and leaves the prober on dir. Kings plus at most two
+// more pieces build in seconds, four pieces take minutes and a few
+// hundred MB.
+bool generate(const std::string& signature, const std::string& dir,
+              std::ostream* log = nullptr);
+
+}  // namespace Tablebases